@@ -0,0 +1,219 @@
+#ifndef ADAPTIVE_HPP
+#define ADAPTIVE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "ode.hpp"
+
+/* Tolerances and limits for the adaptive stepper */
+struct AdaptiveOptions {
+    double atol = 1e-6;      // Absolute tolerance
+    double rtol = 1e-9;      // Relative tolerance
+    double h0 = 0.0;         // Initial step (0 = pick automatically)
+    double hmax = std::numeric_limits<double>::infinity(); // Largest allowed step
+    long max_steps = 10000000; // Give up after this many attempted steps
+};
+
+/* Work counters filled in by the adaptive stepper */
+struct AdaptiveStats {
+    long rhs_evals = 0;
+    long accepted = 0;
+    long rejected = 0;
+    bool reached_tf = false; // Last run got to tf, not cut short by max_steps or a handler
+};
+
+/* Dormand-Prince 5(4) coefficients */
+namespace dopri {
+const double c2 = 1.0 / 5.0, c3 = 3.0 / 10.0, c4 = 4.0 / 5.0, c5 = 8.0 / 9.0;
+const double a21 = 1.0 / 5.0;
+const double a31 = 3.0 / 40.0, a32 = 9.0 / 40.0;
+const double a41 = 44.0 / 45.0, a42 = -56.0 / 15.0, a43 = 32.0 / 9.0;
+const double a51 = 19372.0 / 6561.0, a52 = -25360.0 / 2187.0, a53 = 64448.0 / 6561.0, a54 = -212.0 / 729.0;
+const double a61 = 9017.0 / 3168.0, a62 = -355.0 / 33.0, a63 = 46732.0 / 5247.0, a64 = 49.0 / 176.0,
+             a65 = -5103.0 / 18656.0;
+const double a71 = 35.0 / 384.0, a73 = 500.0 / 1113.0, a74 = 125.0 / 192.0, a75 = -2187.0 / 6784.0,
+             a76 = 11.0 / 84.0;
+// Difference between the 5th and embedded 4th order weights
+const double e1 = 71.0 / 57600.0, e3 = -71.0 / 16695.0, e4 = 71.0 / 1920.0, e5 = -17253.0 / 339200.0,
+             e6 = 22.0 / 525.0, e7 = -1.0 / 40.0;
+} // namespace dopri
+
+/* One Dormand-Prince step of size h from (t, y). k1 must hold f(t, y) on
+ * entry; on exit k7 holds f(t + h, ynew), which becomes the next k1
+ * (first-same-as-last). yerr receives the local error estimate.
+ */
+template <std::size_t N, typename Rhs>
+void dopri5Step(Rhs rhs, double t, const State<N> &y, double h, const State<N> &k1,
+                State<N> &ynew, State<N> &yerr, State<N> &k7) {
+    using namespace dopri;
+    State<N> k2, k3, k4, k5, k6, ytmp;
+
+    for (std::size_t i = 0; i < N; ++i) ytmp[i] = y[i] + h * a21 * k1[i];
+    rhs(t + c2 * h, ytmp, k2);
+    for (std::size_t i = 0; i < N; ++i) ytmp[i] = y[i] + h * (a31 * k1[i] + a32 * k2[i]);
+    rhs(t + c3 * h, ytmp, k3);
+    for (std::size_t i = 0; i < N; ++i) ytmp[i] = y[i] + h * (a41 * k1[i] + a42 * k2[i] + a43 * k3[i]);
+    rhs(t + c4 * h, ytmp, k4);
+    for (std::size_t i = 0; i < N; ++i)
+        ytmp[i] = y[i] + h * (a51 * k1[i] + a52 * k2[i] + a53 * k3[i] + a54 * k4[i]);
+    rhs(t + c5 * h, ytmp, k5);
+    for (std::size_t i = 0; i < N; ++i)
+        ytmp[i] = y[i] + h * (a61 * k1[i] + a62 * k2[i] + a63 * k3[i] + a64 * k4[i] + a65 * k5[i]);
+    rhs(t + h, ytmp, k6);
+    for (std::size_t i = 0; i < N; ++i)
+        ynew[i] = y[i] + h * (a71 * k1[i] + a73 * k3[i] + a74 * k4[i] + a75 * k5[i] + a76 * k6[i]);
+    rhs(t + h, ynew, k7);
+
+    for (std::size_t i = 0; i < N; ++i) {
+        yerr[i] = h * (e1 * k1[i] + e3 * k3[i] + e4 * k4[i] + e5 * k5[i] + e6 * k6[i] + e7 * k7[i]);
+    }
+}
+
+/* Scaled RMS norm of the error estimate; a step is accepted when <= 1 */
+template <std::size_t N>
+double errorNorm(const State<N> &y, const State<N> &ynew, const State<N> &yerr, const AdaptiveOptions &opt) {
+    double sum = 0.0;
+    for (std::size_t i = 0; i < N; ++i) {
+        double scale = opt.atol + opt.rtol * std::max(std::fabs(y[i]), std::fabs(ynew[i]));
+        double e = yerr[i] / scale;
+        sum += e * e;
+    }
+    return std::sqrt(sum / N);
+}
+
+/* Starting step guess from the size of y and f(t0, y0) */
+template <std::size_t N>
+double initialStep(const State<N> &y0, const State<N> &f0, const AdaptiveOptions &opt) {
+    double d0 = 0.0, d1 = 0.0;
+    for (std::size_t i = 0; i < N; ++i) {
+        double scale = opt.atol + opt.rtol * std::fabs(y0[i]);
+        d0 += (y0[i] / scale) * (y0[i] / scale);
+        d1 += (f0[i] / scale) * (f0[i] / scale);
+    }
+    if (d0 < 1e-10 || d1 < 1e-10) return 1e-6;
+    return 0.01 * std::sqrt(d0 / d1);
+}
+
+/* PI step size controller (Hairer, Norsett & Wanner). Given the scaled
+ * error of an attempted step it decides acceptance and updates h for the
+ * next attempt.
+ */
+struct StepController {
+    double safe = 0.9, fac_min = 0.2, fac_max = 10.0;
+    double beta = 0.04, alpha = 0.2 - 0.75 * beta;
+    double err_old = 1e-4;
+    bool last_rejected = false;
+
+    bool accept(double err, double &h) {
+        if (err <= 1.0) {
+            // Accept: PI control on the error history
+            double fac = safe * std::pow(err, -alpha) * std::pow(err_old, beta);
+            if (err == 0.0) fac = fac_max;
+            fac = std::min(fac_max, std::max(fac_min, fac));
+            if (last_rejected) fac = std::min(fac, 1.0);
+            err_old = std::max(err, 1e-4);
+            h *= fac;
+            last_rejected = false;
+            return true;
+        }
+        // Reject: shrink h and retry from the same point
+        h *= std::max(fac_min, safe * std::pow(err, -0.2));
+        last_rejected = true;
+        return false;
+    }
+};
+
+/* Core loop of dormandPrince45Steps: advances (t, y) in place towards tf
+ * with step proposal h and the controller state, so a run can be stopped
+ * and continued (see checkpoint.hpp). k1 = f(t, y) is recomputed on entry.
+ * If the step that lands on tf was shortened to hit it, h is left at the
+ * controller's full-size proposal for the next call. Returns true if the
+ * handler stopped the integration. st.reached_tf records whether t got to
+ * tf, so a run cut short by opt.max_steps is not taken for one that did.
+ */
+template <std::size_t N, typename Rhs, typename StepHandler>
+bool dormandPrince45Advance(Rhs rhs, double &t, State<N> &y, double &h, StepController &control, double tf,
+                            StepHandler &&step, const AdaptiveOptions &opt, AdaptiveStats &st) {
+    State<N> k1, k7, ynew, yerr;
+
+    rhs(t, y, k1);
+    st.rhs_evals++;
+
+    if (h <= 0.0) h = opt.h0 > 0.0 ? opt.h0 : initialStep(y, k1, opt);
+
+    bool stopped = false;
+    for (long n = 0; t < tf && n < opt.max_steps; ++n) {
+        h = std::min(h, opt.hmax);
+        double h_full = h;
+        bool last = (t + h >= tf);
+        if (last) h = tf - t;
+
+        dopri5Step(rhs, t, y, h, k1, ynew, yerr, k7);
+        st.rhs_evals += 6;
+
+        double h_used = h;
+        if (control.accept(errorNorm(y, ynew, yerr, opt), h)) {
+            double tnew = last ? tf : t + h_used;
+            st.accepted++; // Before the handler, which may save st
+            stopped = step(t, y, k1, tnew, ynew, k7);
+            t = tnew;
+            y = ynew;
+            k1 = k7;
+            if (last) h = std::max(h, h_full);
+            if (stopped) break;
+        } else {
+            st.rejected++;
+        }
+    }
+    st.reached_tf = t >= tf;
+    return stopped;
+}
+
+// Adaptive Dormand-Prince 5(4) method
+// Steps from t0 to exactly tf, keeping the local error within atol/rtol.
+// Rejected steps are retried with a smaller h; accepted steps use a PI
+// controller for the next h. out(t, y) is called after every accepted step.
+// If opt.max_steps runs out first the state short of tf is returned and
+// stats->reached_tf is false.
+template <std::size_t N, typename Rhs, typename Output = NoOutput>
+State<N> dormandPrince45(Rhs rhs, double t0, const State<N> &y0, double tf,
+                         const AdaptiveOptions &opt = AdaptiveOptions(), AdaptiveStats *stats = nullptr,
+                         Output out = Output()) {
+    AdaptiveStats local;
+    AdaptiveStats &st = stats ? *stats : local;
+    StepController control;
+
+    double t = t0, h = 0.0;
+    State<N> y = y0;
+    auto step = [&](double, const State<N> &, const State<N> &, double t1, const State<N> &y1, const State<N> &) {
+        out(t1, y1);
+        return false;
+    };
+    dormandPrince45Advance(rhs, t, y, h, control, tf, step, opt, st);
+
+    return y;
+}
+
+// Adaptive Dormand-Prince 5(4) method reporting whole steps
+// Same handler contract as rungeKutta4Steps in ode.hpp; the FSAL stage
+// provides the end-of-step derivative for free. t_end receives the time
+// reached, short of tf if the handler stopped or opt.max_steps ran out.
+template <std::size_t N, typename Rhs, typename StepHandler>
+State<N> dormandPrince45Steps(Rhs rhs, double t0, const State<N> &y0, double tf, StepHandler &&step,
+                              double *t_end = nullptr, const AdaptiveOptions &opt = AdaptiveOptions(),
+                              AdaptiveStats *stats = nullptr) {
+    AdaptiveStats local;
+    AdaptiveStats &st = stats ? *stats : local;
+    StepController control;
+
+    double t = t0;
+    State<N> y = y0;
+    double h = 0.0;
+    dormandPrince45Advance(rhs, t, y, h, control, tf, step, opt, st);
+
+    if (t_end) *t_end = t;
+    return y;
+}
+
+#endif // ADAPTIVE_HPP
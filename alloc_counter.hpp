@@ -0,0 +1,26 @@
+#ifndef ALLOC_COUNTER_HPP
+#define ALLOC_COUNTER_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/* Counts every heap allocation made by the process, for the benchmarks'
+ * allocations per step or per operation: read n_allocs before and after
+ * the measured code. This replaces the global operator new and delete, so
+ * include it in exactly one source file of a program.
+ */
+
+inline std::size_t n_allocs = 0;
+
+void *operator new(std::size_t size) {
+    ++n_allocs;
+    void *p = std::malloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+#endif // ALLOC_COUNTER_HPP
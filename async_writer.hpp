@@ -0,0 +1,166 @@
+#ifndef ASYNC_WRITER_HPP
+#define ASYNC_WRITER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "ode.hpp"
+
+/* Output pipeline that takes file writing off the integration thread.
+ *
+ * The stepper's observer pushes (t, y) into a lock-free single-producer /
+ * single-consumer ring; a background thread pops rows and hands them to a
+ * sink (TrajectoryWriter, TextTrajectoryWriter, or anything with
+ * write(t, y) and close()), which does the formatting, encoding and file
+ * I/O. The sink has to write as rows arrive for this to move the I/O off
+ * the integration thread: TrajectoryWriter writes a block every 8192 rows
+ * and TextTrajectoryWriter whenever its stream buffer fills, so close()
+ * only has the tail left. The producer only waits when the ring is full,
+ * i.e. when the disk side has fallen a whole ring behind (backpressure);
+ * close() lets the thread drain the ring and close the sink, then joins
+ * it.
+ *
+ * Build with -pthread.
+ */
+
+/* Bounded SPSC queue. Capacity is rounded up to a power of two. Producer
+ * and consumer indices live on separate cache lines, and each side keeps
+ * a cached copy of the other's index so the shared lines are only read
+ * when the ring looks full or empty.
+ */
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(std::size_t capacity) {
+        std::size_t cap = 2;
+        while (cap < capacity) cap *= 2;
+        buf.resize(cap);
+        mask = cap - 1;
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    std::size_t capacity() const { return buf.size(); }
+
+    // Producer side
+    bool tryPush(const T &v) {
+        std::size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail_cache == buf.size()) {
+            tail_cache = tail.load(std::memory_order_acquire);
+            if (h - tail_cache == buf.size()) return false;
+        }
+        buf[h & mask] = v;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool tryPop(T &v) {
+        std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head_cache) {
+            head_cache = head.load(std::memory_order_acquire);
+            if (t == head_cache) return false;
+        }
+        v = buf[t & mask];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::vector<T> buf;
+    std::size_t mask = 0;
+
+    alignas(64) std::atomic<std::size_t> head{0}; // Written by the producer
+    std::size_t tail_cache = 0;                   // Producer's view of tail
+    alignas(64) std::atomic<std::size_t> tail{0}; // Written by the consumer
+    std::size_t head_cache = 0;                   // Consumer's view of head
+};
+
+/* Sink running on its own thread behind an SPSC ring of Capacity (t, y)
+ * rows. The sink is built in place from the constructor arguments, e.g.
+ * AsyncWriter<4, TrajectoryWriter> out("rk4_output.traj"), and is also
+ * closed on the background thread, so the caller never touches the disk.
+ */
+template <std::size_t N, typename Sink, std::size_t Capacity = 4096>
+class AsyncWriter {
+public:
+    template <typename... Args>
+    explicit AsyncWriter(Args &&...args)
+        : sink(std::forward<Args>(args)...), ring(Capacity), worker([this] { consume(); }) {}
+
+    ~AsyncWriter() { close(); }
+
+    AsyncWriter(const AsyncWriter &) = delete;
+    AsyncWriter &operator=(const AsyncWriter &) = delete;
+
+    // Queue a row; waits only while the ring is full
+    void write(double t, const State<N> &y) {
+        Row r{t, y};
+        while (!ring.tryPush(r)) {
+            ++full_waits;
+            std::this_thread::yield();
+        }
+    }
+
+    // Observer to pass to the steppers
+    struct Output {
+        AsyncWriter *w;
+        void operator()(double t, const State<N> &y) const { w->write(t, y); }
+    };
+    Output output() { return {this}; }
+
+    // Wait until everything queued is written and the sink is closed.
+    // Returns the sink's close() result.
+    bool close() {
+        if (!worker.joinable()) return ok;
+        done.store(true, std::memory_order_release);
+        worker.join();
+        return ok;
+    }
+
+    // Times the producer found the ring full (backpressure)
+    long fullWaits() const { return full_waits; }
+
+private:
+    struct Row {
+        double t;
+        State<N> y;
+    };
+
+    void consume() {
+        Row r;
+        int idle = 0;
+        for (;;) {
+            if (ring.tryPop(r)) {
+                sink.write(r.t, r.y);
+                idle = 0;
+                continue;
+            }
+            if (done.load(std::memory_order_acquire)) {
+                // Rows pushed before close() are visible now
+                while (ring.tryPop(r)) sink.write(r.t, r.y);
+                ok = sink.close();
+                return;
+            }
+            // Nothing queued: spin briefly, then back off to short sleeps
+            if (++idle < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    }
+
+    Sink sink;
+    SpscRing<Row> ring;
+    std::atomic<bool> done{false};
+    long full_waits = 0;
+    bool ok = true;     // Written by the worker, read after join()
+    std::thread worker; // Last: starts after everything above exists
+};
+
+#endif // ASYNC_WRITER_HPP
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <future>
+#include "orbit.hpp"
+#include "constellation.hpp"
+#include "thread_pool.hpp"
+#include "work_stealing.hpp"
+
+using namespace std;
+
+/* Constellation propagation (constellation.hpp) on 1, 2, 4, ... threads up
+ * to the core count, against the single-queue ThreadPool with one task per
+ * satellite. Satellites span low to high orbits and a fifth of them are on
+ * suborbital arcs that hit the Earth early, so trajectory costs differ by
+ * orders of magnitude.
+ *
+ * Usage: bench_constellation.exe [satellites] [days] [max threads]
+ * Build: g++ -O2 -pthread bench_constellation.cpp -o bench_constellation.exe
+ */
+
+vector<OrbitState> make_constellation(size_t n) {
+    mt19937 gen(7);
+    uniform_real_distribution<double> alt(3.0e5, 3.6e7), angle(0.0, 2.0 * M_PI), ecc(0.0, 0.3);
+    vector<OrbitState> y0(n);
+    for (size_t i = 0; i < n; ++i) {
+        double r = earth_radius + alt(gen), a = angle(gen);
+        double v = sqrt(G * M / r) * sqrt(1.0 + ecc(gen)); // Periapsis speed
+        if (i % 5 == 0) v *= 0.5;                          // Suborbital: falls back
+        y0[i] = {r * cos(a), r * sin(a), -v * sin(a), v * cos(a)};
+    }
+    return y0;
+}
+
+int main(int argc, char *argv[]) {
+    size_t n = argc > 1 ? strtoul(argv[1], nullptr, 10) : 2000;
+    double tf = (argc > 2 ? atof(argv[2]) : 1.0) * 86400.0;
+    double t0 = 0.0;
+
+    vector<OrbitState> y0 = make_constellation(n);
+    ConstellationOptions opt;
+    opt.adaptive.atol = 1e-3;
+    opt.adaptive.rtol = 1e-10;
+
+    // Serial reference
+    auto start = chrono::steady_clock::now();
+    ConstellationResult ref;
+    {
+        WorkStealingPool one(1);
+        ref = propagateConstellation(EarthModel(), y0, t0, tf, one, opt);
+    }
+    double serial_s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    long impacts = 0, evals = 0, min_evals = -1, max_evals = 0;
+    for (size_t i = 0; i < n; ++i) {
+        impacts += ref.impacted[i];
+        long e = ref.stats[i].rhs_evals;
+        evals += e;
+        min_evals = min_evals < 0 ? e : min(min_evals, e);
+        max_evals = max(max_evals, e);
+    }
+    cout << n << " satellites, " << tf / 86400.0 << " days, " << impacts << " impacts, rhs evals per satellite "
+         << min_evals << " to " << max_evals << " (" << evals << " total)" << endl;
+    cout << "Cores: " << thread::hardware_concurrency() << endl;
+    cout << setw(8) << "threads" << setw(18) << "work-stealing [s]" << setw(10) << "speedup" << setw(10) << "steals"
+         << setw(16) << "ThreadPool [s]" << setw(10) << "speedup" << setw(10) << "match" << endl;
+
+    unsigned max_threads = argc > 3 ? atoi(argv[3]) : thread::hardware_concurrency();
+    max_threads = max(1u, max_threads);
+    for (unsigned threads = 1;; threads = min(threads * 2, max_threads)) {
+        // Work-stealing constellation mode
+        WorkStealingPool pool(threads);
+        start = chrono::steady_clock::now();
+        ConstellationResult res = propagateConstellation(EarthModel(), y0, t0, tf, pool, opt);
+        double ws_s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        // One ThreadPool task per satellite, as the q4withInitial search does
+        ConstellationResult tp_res = ref;
+        start = chrono::steady_clock::now();
+        {
+            ThreadPool tp(threads);
+            vector<future<void>> done;
+            for (size_t i = 0; i < n; ++i) {
+                done.push_back(
+                    tp.submit([&, i] { propagateSatellite(EarthModel(), y0[i], t0, tf, opt, tp_res, i); }));
+            }
+            for (future<void> &f : done) f.get();
+        }
+        double tp_s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        // Each trajectory is computed by one thread, so results are bitwise equal
+        bool match = true;
+        for (size_t i = 0; i < n; ++i) {
+            match = match && res.final_states[i] == ref.final_states[i] &&
+                    tp_res.final_states[i] == ref.final_states[i];
+        }
+
+        cout << setw(8) << threads << setw(18) << ws_s << setw(10) << serial_s / ws_s << setw(10) << pool.steals()
+             << setw(16) << tp_s << setw(10) << serial_s / tp_s << setw(10) << (match ? "yes" : "NO") << endl;
+
+        if (threads == max_threads) break;
+    }
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include "orbit.hpp"
+#include "ensemble.hpp"
+
+using namespace std;
+
+/* Ensemble RK4 against calling rungeKutta4 once per trajectory.
+ * The initial conditions are the q4withInitial.cpp velocity scan spread
+ * over many trajectories.
+ *
+ * Build: g++ -O3 -march=native bench_ensemble.cpp -o bench_ensemble.exe
+ */
+
+int main() {
+    const double t0 = 0.0, h = 60.0, tf = 86400.0;
+    const size_t sizes[] = {64, 1024, 8192};
+
+#if defined(__AVX512F__)
+    cout << "Kernel: AVX-512 (8 lanes)" << endl;
+#elif defined(__AVX2__)
+    cout << "Kernel: AVX2 (4 lanes)" << endl;
+#else
+    cout << "Kernel: scalar" << endl;
+#endif
+
+    cout << setw(8) << "N" << setw(16) << "loop [ms]" << setw(16) << "ensemble [ms]" << setw(10) << "speedup"
+         << setw(18) << "max pos diff [m]" << endl;
+
+    for (size_t n : sizes) {
+        vector<OrbitState> y0(n);
+        Ensemble ens(n);
+        for (size_t i = 0; i < n; ++i) {
+            double vx = 3887.3 * (1.0 + 0.5 * i / n);
+            y0[i] = {0.0, 26378100.0, vx, 0.0};
+            ens.set(i, y0[i]);
+        }
+
+        // Scalar loop
+        vector<OrbitState> y_loop(n);
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            y_loop[i] = rungeKutta4(rhs_with_moon, t0, y0[i], h, tf);
+        }
+        double loop_s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        // Ensemble
+        start = chrono::steady_clock::now();
+        rungeKutta4Ensemble<true>(ens, t0, h, tf);
+        double ens_s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        double max_diff = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            OrbitState y = ens.get(i);
+            max_diff = max(max_diff, hypot(y[0] - y_loop[i][0], y[1] - y_loop[i][1]));
+        }
+
+        cout << setw(8) << n << setw(16) << loop_s * 1e3 << setw(16) << ens_s * 1e3 << setw(10)
+             << loop_s / ens_s << setw(18) << max_diff << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,222 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <valarray>
+#include <vector>
+#include "orbit.hpp"
+#include "q2.hpp"
+#include "q2b.hpp"
+#include "run.hpp"
+#include "alloc_counter.hpp"
+
+/* Microbenchmarks of the hot kernels, measured in the headers the
+ * programs use: rhs_earth (orbit.hpp, as in q4.cpp) and rungeKutta4 (ode.hpp),
+ * haversine, interp_coords and read_gps_data (q2.hpp, from q2.cpp),
+ * coords_to_distances (run.hpp and q2b.hpp), lagrange_interp (interp.hpp)
+ * and run.hpp's read_gps_data, on fixtures built from the shipped data
+ * (test_run_coords.dat, interpolated_run_data.dat) and the q4 orbit.
+ *
+ * Each benchmark runs its operation in a loop, doubling the iteration
+ * count until the loop takes at least --min_time seconds, and reports
+ * ns/op, items/s and heap allocations per op. --json=FILE also writes the
+ * results in Google Benchmark's JSON layout for diffing between versions;
+ * --filter=TEXT runs only the benchmarks whose name contains TEXT.
+ *
+ * Build: g++ -O2 -std=c++17 bench_kernels.cpp -o bench_kernels.exe
+ * Run from the repository directory, where the .dat files are.
+ */
+
+using namespace std;
+
+// Keep a result alive so the measured work is not optimized out
+template <typename T>
+inline void keep(const T &v) {
+    asm volatile("" : : "r"(&v) : "memory");
+}
+
+struct Benchmark {
+    string name;
+    long arg;            // Input size
+    double items_per_op; // Items (points, steps, rows, ...) per operation
+    function<void()> op;
+};
+
+struct BenchResult {
+    string name;
+    long iterations;
+    double ns_per_op, items_per_s, allocs_per_op;
+};
+
+BenchResult runBenchmark(const Benchmark &b, double min_time) {
+    b.op(); // Warm up caches and any lazy setup
+    for (long iters = 1;; iters *= 2) {
+        size_t allocs = n_allocs;
+        auto start = chrono::steady_clock::now();
+        for (long i = 0; i < iters; ++i) b.op();
+        double s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        allocs = n_allocs - allocs;
+        if (s >= min_time || iters >= (1L << 40)) {
+            return {b.name + "/" + to_string(b.arg), iters, s * 1e9 / iters, b.items_per_op * iters / s,
+                    static_cast<double>(allocs) / iters};
+        }
+    }
+}
+
+void writeJson(const string &path, const vector<BenchResult> &results) {
+    ofstream out(path);
+    if (!out.is_open()) {
+        cerr << "Error opening file: " << path << endl;
+        return;
+    }
+    out << setprecision(10);
+    out << "{\n  \"context\": {\"executable\": \"bench_kernels\", \"library_build_type\": \"release\"},\n";
+    out << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult &r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"run_type\": \"iteration\", \"iterations\": " << r.iterations
+            << ", \"real_time\": " << r.ns_per_op << ", \"time_unit\": \"ns\", \"items_per_second\": "
+            << r.items_per_s << ", \"allocs_per_op\": " << r.allocs_per_op << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+// First n points of the shipped data, as t / lat / lon columns
+struct Track {
+    valarray<double> t, lat, lon;
+};
+
+Track loadTrack(const string &filename, int n, int columns) {
+    valarray<double> data = columns == 3 ? q2::read_gps_data(filename, n) : ::read_gps_data(filename, n);
+    Track tr;
+    if (data.size() == 0) return tr;
+    int c0 = columns - 3; // interpolated_run_data.dat starts with an index column
+    tr.t = valarray<double>(data[slice(c0, n, columns)]);
+    tr.lat = valarray<double>(data[slice(c0 + 1, n, columns)]);
+    tr.lon = valarray<double>(data[slice(c0 + 2, n, columns)]);
+    return tr;
+}
+
+int main(int argc, char *argv[]) {
+    string json, filter;
+    double min_time = 0.1;
+    for (int i = 1; i < argc; ++i) {
+        string a = argv[i];
+        if (a.rfind("--json=", 0) == 0) {
+            json = a.substr(7);
+        } else if (a.rfind("--filter=", 0) == 0) {
+            filter = a.substr(9);
+        } else if (a.rfind("--min_time=", 0) == 0) {
+            min_time = atof(a.c_str() + 11);
+        } else {
+            cerr << "Usage: bench_kernels.exe [--json=FILE] [--filter=TEXT] [--min_time=SECONDS]" << endl;
+            return 1;
+        }
+    }
+
+    // Fixtures
+    const int n_coords = 1408, n_interp = 14071;
+    Track coords = loadTrack("test_run_coords.dat", n_coords, 3);
+    Track interp = loadTrack("interpolated_run_data.dat", n_interp, 4);
+    if (coords.t.size() == 0 || interp.t.size() == 0) {
+        cerr << "Run from the repository directory: the fixtures come from its .dat files" << endl;
+        return 1;
+    }
+    const OrbitState y0 = {0.0, 26378100.0, 3887.3, 0.0}; // q4 initial conditions
+
+    vector<Benchmark> benches;
+
+    // rhs and RK4 of q4.cpp, without file output
+    benches.push_back({"rhs_earth", 1, 1.0, [y0] {
+                           OrbitState dydt;
+                           rhs_earth(0.0, y0, dydt);
+                           keep(dydt);
+                       }});
+    for (long steps : {1000L, 10000L, 86400L}) {
+        benches.push_back({"rungeKutta4", steps, double(steps), [y0, steps] {
+                               OrbitState y = ::rungeKutta4(rhs_earth, 0.0, y0, 1.0, double(steps));
+                               keep(y);
+                           }});
+    }
+
+    // Per-point kernels over consecutive points of a track
+    auto prefix = [](const Track &tr, size_t n) {
+        Track p;
+        p.t = valarray<double>(tr.t[slice(0, n, 1)]);
+        p.lat = valarray<double>(tr.lat[slice(0, n, 1)]);
+        p.lon = valarray<double>(tr.lon[slice(0, n, 1)]);
+        return p;
+    };
+    vector<Track> tracks = {prefix(coords, 100), coords, interp};
+
+    for (const Track &tr : tracks) {
+        long n = tr.t.size();
+        benches.push_back({"haversine", n - 1, double(n - 1), [tr, n] {
+                               double d = 0.0;
+                               for (long i = 1; i < n; ++i)
+                                   d += q2::haversine(tr.lat[i - 1], tr.lon[i - 1], tr.lat[i], tr.lon[i]);
+                               keep(d);
+                           }});
+        benches.push_back({"coords_to_distances.run", n, double(n - 1), [tr] {
+                               valarray<double> d = ::coords_to_distances(tr.lat, tr.lon);
+                               keep(d);
+                           }});
+        benches.push_back({"coords_to_distances.q2b", n, double(n - 1), [tr] {
+                               valarray<double> d = q2b::coords_to_distances(tr.lat, tr.lon);
+                               keep(d);
+                           }});
+    }
+
+    // Lagrange interpolation through n points
+    for (long n : {3L, 5L, 9L}) {
+        valarray<double> x = coords.t[slice(0, n, 1)], y = coords.lat[slice(0, n, 1)];
+        double at = 0.5 * (x[0] + x[n - 1]) + 0.25;
+        benches.push_back({"lagrange_interp", n, 1.0, [x, y, at] {
+                               double v = lagrange_interp(x, y, at);
+                               keep(v);
+                           }});
+    }
+
+    // interp_coords on q2.cpp's 0.1 s grid: 64 evaluations spread over
+    // the track, so the linear segment search is measured too
+    for (const Track &tr : {tracks[0], tracks[1]}) {
+        long n = tr.t.size();
+        // interp_coords takes non-const references: give it its own copies
+        benches.push_back({"interp_coords", n, 64.0, [t = tr.t, lat = tr.lat]() mutable {
+                               double t0 = t[0], span = t[t.size() - 1] - t[0], v = 0.0;
+                               for (int k = 0; k < 64; ++k) v += q2::interp_coords(t, lat, t0 + span * (k + 0.5) / 64);
+                               keep(v);
+                           }});
+    }
+
+    // File parsing, rows per op
+    for (int n : {100, n_coords}) {
+        benches.push_back({"read_gps_data.q2", n, double(n), [n] {
+                               valarray<double> d = q2::read_gps_data("test_run_coords.dat", n);
+                               keep(d);
+                           }});
+    }
+    for (int n : {1000, n_interp}) {
+        benches.push_back({"read_gps_data.run", n, double(n), [n] {
+                               valarray<double> d = ::read_gps_data("interpolated_run_data.dat", n);
+                               keep(d);
+                           }});
+    }
+
+    vector<BenchResult> results;
+    cout << left << setw(34) << "benchmark" << right << setw(14) << "ns/op" << setw(14) << "items/s"
+         << setw(14) << "allocs/op" << setw(14) << "iterations" << endl;
+    for (const Benchmark &b : benches) {
+        if (!filter.empty() && b.name.find(filter) == string::npos) continue;
+        BenchResult r = runBenchmark(b, min_time);
+        results.push_back(r);
+        cout << left << setw(34) << r.name << right << setw(14) << setprecision(4) << r.ns_per_op << setw(14)
+             << r.items_per_s << setw(14) << r.allocs_per_op << setw(14) << r.iterations << endl;
+    }
+    if (!json.empty()) writeJson(json, results);
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "orbit.hpp"
+#include "nbody.hpp"
+
+using namespace std;
+
+/* Scaling of the N-body force evaluation from 3 to 100000 bodies: direct
+ * sum against Barnes-Hut, with the Barnes-Hut acceleration error relative
+ * to the direct sum. N = 3 is Earth, Moon and the q4 satellite; larger
+ * systems are the Earth and Moon plus a disk of bodies in circular orbits
+ * carrying a tenth of the Earth's mass between them. The error is the RMS
+ * acceleration difference over the RMS acceleration (the Earth's own net
+ * pull nearly cancels, so a per-body relative error means little). Also
+ * times one RK4 step with the Auto method.
+ *
+ * Build: g++ -O3 -march=native bench_nbody.cpp -o bench_nbody.exe
+ */
+
+NBody make_system(size_t n) {
+    NBody sys;
+    sys.add(M, {0.0, 0.0, 0.0, 0.0});
+    sys.add(ML, {moon_distance, 0.0, 0.0, sqrt(G * M / moon_distance)});
+    sys.add(1000.0, {0.0, 26378100.0, 3887.3, 0.0});
+
+    mt19937 gen(42);
+    uniform_real_distribution<double> radius(1.2e7, 3.0e8), angle(0.0, 2.0 * M_PI);
+    while (sys.size() < n) {
+        double r = radius(gen), a = angle(gen);
+        double v = sqrt(G * M / r);
+        sys.add(0.1 * M / n, {r * cos(a), r * sin(a), -v * sin(a), v * cos(a)});
+    }
+    return sys;
+}
+
+// Seconds per call of f, repeated for at least 0.2 s
+template <typename F>
+double time_per_call(F f) {
+    int calls = 0;
+    auto start = chrono::steady_clock::now();
+    double elapsed = 0.0;
+    do {
+        f();
+        ++calls;
+        elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    } while (elapsed < 0.2);
+    return elapsed / calls;
+}
+
+int main() {
+    const size_t sizes[] = {3, 10, 100, 1000, 10000, 100000};
+
+#if defined(__AVX512F__)
+    cout << "Direct kernel: AVX-512 (8 lanes)" << endl;
+#elif defined(__AVX2__)
+    cout << "Direct kernel: AVX2 (4 lanes)" << endl;
+#else
+    cout << "Direct kernel: scalar" << endl;
+#endif
+
+    cout << setw(8) << "N" << setw(14) << "direct [ms]" << setw(14) << "B-H [ms]" << setw(10) << "speedup"
+         << setw(16) << "B-H rel error" << setw(14) << "RK4 step [ms]" << endl;
+
+    for (size_t n : sizes) {
+        NBody sys = make_system(n);
+        vector<double> ax(n), ay(n), bx(n), by(n);
+
+        NBodyOptions direct_opt, tree_opt;
+        direct_opt.method = NBodyMethod::Direct;
+        tree_opt.method = NBodyMethod::BarnesHut;
+        NBodyForces direct(direct_opt), tree(tree_opt);
+
+        double direct_s =
+            time_per_call([&] { direct(sys.gm.data(), sys.x.data(), sys.y.data(), n, ax.data(), ay.data()); });
+        double tree_s =
+            time_per_call([&] { tree(sys.gm.data(), sys.x.data(), sys.y.data(), n, bx.data(), by.data()); });
+
+        // Barnes-Hut error against the direct sum
+        double err2 = 0.0, acc2 = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            err2 += (bx[i] - ax[i]) * (bx[i] - ax[i]) + (by[i] - ay[i]) * (by[i] - ay[i]);
+            acc2 += ax[i] * ax[i] + ay[i] * ay[i];
+        }
+        double rel_err = sqrt(err2 / acc2);
+
+        // RK4 steps with the method Auto picks for this size
+        NBody run = sys;
+        double step_s = time_per_call([&] { rungeKutta4NBody(run, 0.0, 60.0, 60.0); });
+
+        cout << setw(8) << n << setw(14) << direct_s * 1e3 << setw(14) << tree_s * 1e3 << setw(10)
+             << direct_s / tree_s << setw(16) << rel_err << setw(14) << step_s * 1e3 << endl;
+    }
+
+    return 0;
+}
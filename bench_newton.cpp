@@ -0,0 +1,89 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "newton.hpp"
+
+using namespace std;
+
+/* Work of the Newton modes in newton.hpp (Newton, chord, Broyden) on the
+ * discretised Bratu problem u'' + lambda e^u = 0, u(0) = u(1) = 0, with
+ * n interior points. As in most real problems the Jacobian comes from
+ * forward differences, costing n evaluations of F, so Jacobian
+ * evaluations dominate. Runs with compile-time n = 16 (State<16>) and
+ * runtime n = 64 and 256 (std::vector).
+ *
+ * Build: g++ -O2 bench_newton.cpp -o bench_newton.exe
+ */
+
+const double lambda_bratu = 3.0;
+
+template <typename Vec>
+void bratu(Vec &fx, const Vec &u) {
+    const size_t n = u.size();
+    const double h = 1.0 / (n + 1);
+    for (size_t i = 0; i < n; ++i) {
+        double left = i > 0 ? u[i - 1] : 0.0, right = i + 1 < n ? u[i + 1] : 0.0;
+        fx[i] = (left - 2.0 * u[i] + right) / (h * h) + lambda_bratu * exp(u[i]);
+    }
+}
+
+// Forward-difference Jacobian: one column per evaluation of F
+template <typename Vec, typename Mat>
+void bratuJacobian(Mat &J, const Vec &u) {
+    const size_t n = u.size();
+    Vec f0 = u, f1 = u, up = u;
+    bratu(f0, u);
+    for (size_t j = 0; j < n; ++j) {
+        double d = 1e-7 * (1.0 + fabs(u[j]));
+        up[j] = u[j] + d;
+        bratu(f1, up);
+        up[j] = u[j];
+        for (size_t i = 0; i < n; ++i) J[i][j] = (f1[i] - f0[i]) / d;
+    }
+}
+
+template <typename Vec>
+void run(const string &name, Vec x0) {
+    const size_t n = x0.size();
+    cout << name << ", n = " << n << endl;
+    cout << setw(10) << "mode" << setw(8) << "conv" << setw(8) << "iter" << setw(10) << "J evals" << setw(10)
+         << "F evals" << setw(12) << "F total" << setw(14) << "time [us]" << setw(14) << "max u" << endl;
+    const pair<NewtonMode, const char *> modes[] = {
+        {NewtonMode::Newton, "Newton"}, {NewtonMode::Chord, "chord"}, {NewtonMode::Broyden, "Broyden"}};
+    for (const auto &m : modes) {
+        NewtonOptions opt;
+        opt.mode = m.first;
+        opt.xtol = 1e-10;
+        NewtonStats st;
+        Vec x = x0;
+        const int reps = 20;
+        bool ok = false;
+        auto start = chrono::steady_clock::now();
+        for (int r = 0; r < reps; ++r) {
+            x = x0;
+            st = NewtonStats();
+            ok = NewtonStatus::Converged == newtonSolve(
+                [](Vec &fx, const Vec &u) { bratu(fx, u); },
+                [](auto &J, const Vec &u) { bratuJacobian(J, u); }, x, opt, &st);
+        }
+        double us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / reps;
+        double umax = 0.0;
+        for (size_t i = 0; i < n; ++i) umax = max(umax, x[i]);
+        // Each Jacobian costs n + 1 evaluations of F
+        long f_total = st.f_evals + st.jac_evals * long(n + 1);
+        cout << setw(10) << m.second << setw(8) << (ok ? "yes" : "no") << setw(8) << st.iterations << setw(10)
+             << st.jac_evals << setw(10) << st.f_evals << setw(12) << f_total << setw(14) << us << setw(14)
+             << umax << endl;
+    }
+    cout << endl;
+}
+
+int main() {
+    run("Compile-time size", State<16>());
+    run("Runtime size", vector<double>(64, 0.0));
+    run("Runtime size", vector<double>(256, 0.0));
+    return 0;
+}
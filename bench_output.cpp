@@ -0,0 +1,98 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include "orbit.hpp"
+#include "trajectory.hpp"
+#include "async_writer.hpp"
+
+using namespace std;
+
+/* Cost of writing the trajectory on the q4.cpp run (RK4, h = 1 s,
+ * 10000 steps): formatted text with endl (the old .dat writers), text with
+ * '\n', and the binary columnar TrajectoryWriter, against no output; the
+ * last two again behind an AsyncWriter, where the integration thread only
+ * pushes rows into the ring. On a single core the background thread
+ * competes with the integrator, so the async rows only pay off with a
+ * core to spare.
+ *
+ * Build: g++ -O2 -pthread bench_output.cpp -o bench_output.exe
+ */
+
+template <typename Run>
+double seconds(Run run, int repeats) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < repeats; ++i) run();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count() / repeats;
+}
+
+int main() {
+    const double t0 = 0.0, h = 1.0, tf = 10000.0;
+    const OrbitState y0 = {0.0, 26378100.0, 3887.3, 0.0};
+    const int repeats = 20;
+    const double steps = (tf - t0) / h;
+
+    double none_s = seconds([&] { rungeKutta4(EarthModel(), t0, y0, h, tf); }, repeats);
+
+    double endl_s = seconds(
+        [&] {
+            ofstream outFile("bench_output.dat");
+            rungeKutta4(EarthModel(), t0, y0, h, tf, [&](double t, const OrbitState &yt) {
+                outFile << t << " " << yt[0] << " " << yt[1] << " " << yt[2] << " " << yt[3] << endl;
+            });
+        },
+        repeats);
+
+    double newline_s = seconds(
+        [&] {
+            ofstream outFile("bench_output.dat");
+            rungeKutta4(EarthModel(), t0, y0, h, tf, [&](double t, const OrbitState &yt) {
+                outFile << t << " " << yt[0] << " " << yt[1] << " " << yt[2] << " " << yt[3] << '\n';
+            });
+        },
+        repeats);
+
+    double binary_s = seconds(
+        [&] {
+            TrajectoryWriter outFile("bench_output.traj");
+            rungeKutta4(EarthModel(), t0, y0, h, tf, outFile.output());
+            outFile.close();
+        },
+        repeats);
+
+    double async_text_s = seconds(
+        [&] {
+            AsyncWriter<4, TextTrajectoryWriter> outFile("bench_output.dat");
+            rungeKutta4(EarthModel(), t0, y0, h, tf, outFile.output());
+            outFile.close();
+        },
+        repeats);
+
+    long full_waits = 0;
+    double async_binary_s = seconds(
+        [&] {
+            AsyncWriter<4, TrajectoryWriter> outFile("bench_output.traj");
+            rungeKutta4(EarthModel(), t0, y0, h, tf, outFile.output());
+            outFile.close();
+            full_waits += outFile.fullWaits();
+        },
+        repeats);
+
+    cout << "RK4 with output, " << steps << " steps; output cost per step beyond the integration" << endl;
+    cout << setw(22) << "writer" << setw(14) << "run [ms]" << setw(18) << "output [ns/step]" << endl;
+    auto row = [&](const char *name, double s) {
+        cout << setw(22) << name << setw(14) << s * 1e3 << setw(18) << (s - none_s) * 1e9 / steps << endl;
+    };
+    row("none", none_s);
+    row("text + endl", endl_s);
+    row("text + '\\n'", newline_s);
+    row("binary .traj", binary_s);
+    row("async text", async_text_s);
+    row("async binary .traj", async_binary_s);
+    cout << "async binary: producer found the ring full " << full_waits / repeats << " times per run" << endl;
+
+    remove("bench_output.dat");
+    remove("bench_output.traj");
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+#include "orbit.hpp"
+#include "precision.hpp"
+#include "ensemble.hpp"
+#include "kepler.hpp"
+
+using namespace std;
+
+/* Throughput and accuracy of the precision modes.
+ *
+ * Scalar: rungeKutta4 with EarthModel in float, double and DoubleDouble
+ * on the q4 orbit with h = 1 s. The error against the Kepler solution is
+ * the total error; the difference from the DoubleDouble run, which has
+ * the same truncation error, is what round-off alone adds.
+ *
+ * Ensemble: the Earth+Moon SIMD ensemble (ensemble.hpp) in double and in
+ * float, where each vector holds twice the trajectories.
+ *
+ * Build: g++ -O3 -march=native bench_precision.cpp -o bench_precision.exe
+ * Usage: bench_precision.exe [days]
+ */
+
+template <typename Run>
+double seconds(Run run) {
+    auto start = chrono::steady_clock::now();
+    run();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+template <typename T>
+BasicState<T, 4> toState(const OrbitState &y) {
+    return {T(y[0]), T(y[1]), T(y[2]), T(y[3])};
+}
+
+template <typename T>
+OrbitState toDouble(const BasicState<T, 4> &y) {
+    return {double(y[0]), double(y[1]), double(y[2]), double(y[3])};
+}
+
+int main(int argc, char *argv[]) {
+    double days = argc > 1 ? atof(argv[1]) : 1.0;
+    const double t0 = 0.0, h = 1.0, tf = days * 86400.0;
+    const OrbitState y0 = {0.0, 26378100.0, 3887.3, 0.0};
+    const double steps = (tf - t0) / h;
+
+    OrbitState y_exact = KeplerOrbit(y0, G * M, t0).state(tf);
+
+    BasicState<float, 4> yf;
+    OrbitState yd;
+    BasicState<DoubleDouble, 4> ydd;
+    double f_s = seconds([&] { yf = rungeKutta4(EarthModel(), t0, toState<float>(y0), h, tf); });
+    double d_s = seconds([&] { yd = rungeKutta4(EarthModel(), t0, y0, h, tf); });
+    double dd_s = seconds([&] { ydd = rungeKutta4(EarthModel(), t0, toState<DoubleDouble>(y0), h, tf); });
+    OrbitState y_ref = toDouble(ydd);
+
+    auto posErr = [](const OrbitState &a, const OrbitState &b) { return hypot(a[0] - b[0], a[1] - b[1]); };
+
+    cout << "RK4, Earth only, h = " << h << " s, " << days << " days (" << steps << " steps)" << endl;
+    cout << setw(14) << "scalar" << setw(14) << "ns/step" << setw(16) << "Msteps/s" << setw(20)
+         << "error vs Kepler [m]" << setw(22) << "round-off vs dd [m]" << endl;
+    auto row = [&](const char *name, double s, const OrbitState &y) {
+        cout << setw(14) << name << setw(14) << s * 1e9 / steps << setw(16) << steps / s / 1e6 << setw(20)
+             << posErr(y, y_exact) << setw(22) << posErr(y, y_ref) << endl;
+    };
+    row("float", f_s, toDouble(yf));
+    row("double", d_s, yd);
+    row("double-double", dd_s, y_ref);
+
+    // SIMD ensemble, 60 s steps over the same span
+    const size_t n = 8192;
+    const double he = 60.0;
+    Ensemble ens(n);
+    EnsembleF ensf(n);
+    for (size_t i = 0; i < n; ++i) {
+        OrbitState s = {0.0, 26378100.0, 3887.3 * (1.0 + 0.5 * i / n), 0.0};
+        ens.set(i, s);
+        ensf.set(i, s);
+    }
+    double ens_s = seconds([&] { rungeKutta4Ensemble<true>(ens, t0, he, tf); });
+    double ensf_s = seconds([&] { rungeKutta4Ensemble<true>(ensf, t0, he, tf); });
+    double max_diff = 0.0;
+    for (size_t i = 0; i < n; ++i) max_diff = max(max_diff, posErr(ens.get(i), ensf.get(i)));
+
+    double traj_steps = n * (tf - t0) / he;
+    cout << endl << "Ensemble RK4, Earth + Moon, " << n << " trajectories, h = " << he << " s" << endl;
+    cout << setw(14) << "ensemble" << setw(14) << "ns/step" << setw(16) << "Msteps/s" << endl;
+    cout << setw(14) << "double" << setw(14) << ens_s * 1e9 / traj_steps << setw(16) << traj_steps / ens_s / 1e6
+         << endl;
+    cout << setw(14) << "float" << setw(14) << ensf_s * 1e9 / traj_steps << setw(16)
+         << traj_steps / ensf_s / 1e6 << endl;
+    cout << "float speedup " << ens_s / ensf_s << ", max position difference " << max_diff << " m" << endl;
+    return 0;
+}
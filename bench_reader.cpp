@@ -0,0 +1,120 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "orbit.hpp"
+#include "trajectory.hpp"
+#include "mapped_trajectory.hpp"
+
+using namespace std;
+
+/* Summary job over many output files: the last state of each of K one-day
+ * trajectories (86400 rows) read with getline over the text .dat file,
+ * readTrajectory, and MappedTrajectory / lastLine on mapped files; then
+ * random state-at-time queries on one file. Warm page cache, so this
+ * measures the reading work rather than the disk.
+ *
+ * Usage: bench_reader.exe [files]
+ */
+
+template <typename Run>
+double seconds(Run run) {
+    auto start = chrono::steady_clock::now();
+    run();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    int files = argc > 1 ? atoi(argv[1]) : 20;
+    const double t0 = 0.0, h = 1.0, tf = 86400.0;
+    const OrbitState y0 = {0.0, 26378100.0, 3887.3, 0.0};
+
+    // One trajectory, stored under K names in both formats
+    vector<double> ts;
+    vector<OrbitState> ys;
+    rungeKutta4(EarthModel(), t0, y0, h, tf, [&](double t, const OrbitState &y) {
+        ts.push_back(t);
+        ys.push_back(y);
+    });
+    for (int k = 0; k < files; ++k) {
+        TrajectoryWriter traj("bench_reader" + to_string(k) + ".traj");
+        ofstream text("bench_reader" + to_string(k) + ".dat");
+        for (size_t r = 0; r < ts.size(); ++r) {
+            traj.write(ts[r], ys[r]);
+            text << ts[r] << " " << ys[r][0] << " " << ys[r][1] << " " << ys[r][2] << " " << ys[r][3] << '\n';
+        }
+    }
+
+    double check = 0.0; // Keeps the reads from being optimized out
+    double getline_s = seconds([&] {
+        for (int k = 0; k < files; ++k) {
+            ifstream in("bench_reader" + to_string(k) + ".dat");
+            string line, last;
+            while (getline(in, line)) last = line;
+            check += last.size();
+        }
+    });
+    double lastline_s = seconds([&] {
+        for (int k = 0; k < files; ++k) {
+            MappedFile file;
+            file.open("bench_reader" + to_string(k) + ".dat");
+            check += lastLine(file).size();
+        }
+    });
+    double read_s = seconds([&] {
+        for (int k = 0; k < files; ++k) {
+            Trajectory traj;
+            readTrajectory("bench_reader" + to_string(k) + ".traj", traj);
+            check += traj.columns[0].back();
+        }
+    });
+    double mapped_s = seconds([&] {
+        for (int k = 0; k < files; ++k) {
+            MappedTrajectory traj;
+            traj.open("bench_reader" + to_string(k) + ".traj");
+            check += traj.time(traj.rows() - 1);
+        }
+    });
+
+    cout << "Last state of " << files << " files of " << ts.size() << " rows" << endl;
+    cout << setw(28) << "reader" << setw(16) << "per file [us]" << endl;
+    cout << setw(28) << "text getline scan" << setw(16) << getline_s * 1e6 / files << endl;
+    cout << setw(28) << "text mapped lastLine" << setw(16) << lastline_s * 1e6 / files << endl;
+    cout << setw(28) << "readTrajectory" << setw(16) << read_s * 1e6 / files << endl;
+    cout << setw(28) << "MappedTrajectory" << setw(16) << mapped_s * 1e6 / files << endl;
+
+    // Random state-at-time queries against the stored rows
+    const int queries = 100000;
+    MappedTrajectory traj;
+    traj.open("bench_reader0.traj");
+    srand(1);
+    double max_err = 0.0;
+    double query_s = seconds([&] {
+        OrbitState y;
+        for (int q = 0; q < queries; ++q) {
+            size_t r = static_cast<size_t>(rand()) % ts.size();
+            traj.state(ts[r], y);
+            max_err = max(max_err, fabs(y[0] - ys[r][0]));
+        }
+    });
+    double mid_s = seconds([&] {
+        OrbitState y;
+        for (int q = 0; q < queries; ++q) {
+            traj.state(t0 + h * (0.5 + rand() % (ts.size() - 1)), y);
+            check += y[0];
+        }
+    });
+    cout << "state(t): " << query_s * 1e9 / queries << " ns per query on a row, " << mid_s * 1e9 / queries
+         << " ns between rows (max error on rows " << max_err << " m)" << endl;
+
+    for (int k = 0; k < files; ++k) {
+        remove(("bench_reader" + to_string(k) + ".traj").c_str());
+        remove(("bench_reader" + to_string(k) + ".dat").c_str());
+    }
+    return check == 0.0;
+}
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <cmath>
+#include <chrono>
+#include <valarray>
+#include "orbit.hpp"
+#include "alloc_counter.hpp"
+
+using namespace std;
+
+/* Before/after benchmark of rungeKutta4 on the 86400 s run from q486400.cpp.
+ * "before" is the valarray-by-value version the q4 programs used to carry,
+ * "after" is the fixed-size template from ode.hpp, called once with the
+ * plain function rhs_earth and once with the EarthModel functor from
+ * orbit.hpp (RHS inlined, G * M folded). File output is left out so only the
+ * integrator itself is measured. Each version is timed in interleaved
+ * rounds and the fastest round is reported.
+ *
+ * Build: g++ -O2 bench_rk4.cpp -o bench_rk4.exe
+ */
+
+// Old RHS: takes the state by value and returns a fresh valarray
+valarray<double> rhs_valarray(double /*t*/, valarray<double> yvec) {
+    valarray<double> dydt(yvec.size());
+
+    double GM = G * M;
+    double r = sqrt(yvec[0] * yvec[0] + yvec[1] * yvec[1]);
+    double r_cubed = r * r * r;
+
+    dydt[0] = yvec[2];
+    dydt[1] = yvec[3];
+    dydt[2] = -GM * yvec[0] / r_cubed;
+    dydt[3] = -GM * yvec[1] / r_cubed;
+
+    return dydt;
+}
+
+// Old Runge-Kutta 4th order method
+valarray<double> rungeKutta4_valarray(double t0, valarray<double> y0, double h, double tf) {
+    double t = t0;
+    valarray<double> y = y0;
+    valarray<double> k1, k2, k3, k4;
+
+    while (t < tf) {
+        k1 = h * rhs_valarray(t, y);
+        k2 = h * rhs_valarray(t + h / 2.0, y + k1 / 2.0);
+        k3 = h * rhs_valarray(t + h / 2.0, y + k2 / 2.0);
+        k4 = h * rhs_valarray(t + h, y + k3);
+        y += (k1 + 2.0 * k2 + 2.0 * k3 + k4) / 6.0;
+        t += h;
+    }
+
+    return y;
+}
+
+struct Timing {
+    double ns_per_step = INFINITY; // Best round
+    double allocs_per_step = 0.0;
+};
+
+// Time `runs` calls of run() per round and keep the fastest round, so a
+// busy moment on the machine does not end up in the result
+template <typename Run>
+void timeRound(Run run, int runs, long steps, Timing &timing) {
+    size_t allocs_start = n_allocs;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < runs; ++i) run();
+    double s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    timing.ns_per_step = min(timing.ns_per_step, s * 1e9 / (runs * steps));
+    timing.allocs_per_step = static_cast<double>(n_allocs - allocs_start) / (runs * steps);
+}
+
+int main() {
+    const double t0 = 0.0, h = 60.0, tf = 86400.0;
+    const int rounds = 10, runs = 200;
+    const long steps = static_cast<long>(tf / h);
+
+    valarray<double> y0_valarray = {0.0, 26378100.0, 3887.3, 0.0};
+    State<4> y0_fixed = {0.0, 26378100.0, 3887.3, 0.0};
+
+    // Rounds of the three versions are interleaved so that they see the
+    // same machine conditions
+    double sink = 0.0;
+    Timing before, after, model;
+    for (int r = 0; r < rounds; ++r) {
+        timeRound([&] { sink += rungeKutta4_valarray(t0, y0_valarray, h, tf)[0]; }, runs, steps, before);
+        timeRound([&] { sink += rungeKutta4(rhs_earth, t0, y0_fixed, h, tf)[0]; }, runs, steps, after);
+        timeRound([&] { sink += rungeKutta4(EarthModel(), t0, y0_fixed, h, tf)[0]; }, runs, steps, model);
+    }
+
+    cout << "rungeKutta4, h = " << h << " s, tf = " << tf << " s, best of " << rounds << " rounds of " << runs
+         << " runs" << endl;
+    cout << "valarray   : " << before.ns_per_step << " ns/step, " << before.allocs_per_step << " allocs/step"
+         << endl;
+    cout << "State<4>   : " << after.ns_per_step << " ns/step, " << after.allocs_per_step << " allocs/step"
+         << endl;
+    cout << "EarthModel : " << model.ns_per_step << " ns/step, " << model.allocs_per_step << " allocs/step"
+         << endl;
+    cout << "Speedup    : " << before.ns_per_step / after.ns_per_step << "x (function), "
+         << before.ns_per_step / model.ns_per_step << "x (model)" << endl;
+    cout << "(checksum " << sink << ")" << endl;
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <map>
+#include "orbit.hpp"
+#include "adaptive.hpp"
+#include "symplectic.hpp"
+#include "kepler.hpp"
+#include "multistep.hpp"
+
+using namespace std;
+
+/* Work-precision table for every stepper on the q4.cpp two-body problem.
+ * Each row is one stepper at one step size or tolerance: wall time, number
+ * of rhs (or acceleration) evaluations, final position error against the
+ * closed-form Kepler solution and relative energy error. The Kepler
+ * propagator itself is listed as the zero-evaluation reference point.
+ *
+ * Usage:
+ *   bench_workprecision                  write work_precision.dat
+ *   bench_workprecision baseline.dat     also compare against a baseline and
+ *                                        exit 1 if evals or errors regressed
+ *
+ * Build: g++ -O2 bench_workprecision.cpp -o bench_workprecision.exe
+ */
+
+static long evals = 0;
+
+void rhs_counted(double t, const OrbitState &y, OrbitState &dydt) {
+    ++evals;
+    rhs_earth(t, y, dydt);
+}
+
+void accel_counted(double t, const State<2> &q, State<2> &a) {
+    ++evals;
+    accel_earth(t, q, a);
+}
+
+struct Row {
+    string method;
+    double param; // Step size in s or relative tolerance
+    double time_ms;
+    long evals;
+    double pos_error;
+    double energy_error;
+};
+
+template <typename Integrate>
+Row measure(const string &method, double param, const OrbitState &y0, const OrbitState &y_exact, Integrate integrate) {
+    // Repeat cheap runs so the timing is not dominated by clock resolution
+    int repeats = 0;
+    OrbitState y;
+    long run_evals = 0;
+    auto start = chrono::steady_clock::now();
+    double elapsed = 0.0;
+    do {
+        evals = 0;
+        y = integrate();
+        run_evals = evals;
+        ++repeats;
+        elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    } while (elapsed < 0.05 && repeats < 1000);
+
+    Row row;
+    row.method = method;
+    row.param = param;
+    row.time_ms = elapsed * 1e3 / repeats;
+    row.evals = run_evals;
+    row.pos_error = hypot(y[0] - y_exact[0], y[1] - y_exact[1]);
+    row.energy_error = fabs((energy_earth(y) - energy_earth(y0)) / energy_earth(y0));
+    return row;
+}
+
+// Compare against a baseline table; a row regresses when it needs more
+// evaluations or is more than 10% less accurate
+int check_baseline(const string &filename, const vector<Row> &rows) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Error opening file: " << filename << endl;
+        return 1;
+    }
+
+    map<string, Row> baseline;
+    string line;
+    getline(file, line); // Header
+    while (getline(file, line)) {
+        stringstream ss(line);
+        Row r;
+        ss >> r.method >> r.param >> r.time_ms >> r.evals >> r.pos_error >> r.energy_error;
+        stringstream key;
+        key << r.method << " " << r.param;
+        baseline[key.str()] = r;
+    }
+
+    int regressions = 0;
+    for (const Row &r : rows) {
+        stringstream key;
+        key << r.method << " " << r.param;
+        auto it = baseline.find(key.str());
+        if (it == baseline.end()) continue;
+        const Row &b = it->second;
+        if (r.evals > b.evals || r.pos_error > 1.1 * b.pos_error + 1e-9) {
+            cout << "REGRESSION " << key.str() << ": evals " << b.evals << " -> " << r.evals << ", pos error "
+                 << b.pos_error << " -> " << r.pos_error << endl;
+            ++regressions;
+        }
+    }
+    cout << regressions << " regression(s) against " << filename << endl;
+    return regressions > 0 ? 1 : 0;
+}
+
+int main(int argc, char *argv[]) {
+    // Initial conditions from q4.cpp
+    const OrbitState y0 = {0.0, 26378100.0, 3887.3, 0.0}; // x0, y0, vx0, vy0
+    const double t0 = 0.0, tf = 86400.0;
+    const OrbitState y_exact = keplerPropagate(y0, G * M, tf - t0);
+
+    vector<Row> rows;
+    const double steps[] = {600.0, 300.0, 120.0, 60.0, 30.0, 10.0, 1.0};
+    for (double h : steps) {
+        rows.push_back(measure("euler", h, y0, y_exact, [&] { return euler(rhs_counted, t0, y0, h, tf); }));
+        rows.push_back(measure("rk4", h, y0, y_exact, [&] { return rungeKutta4(rhs_counted, t0, y0, h, tf); }));
+        rows.push_back(
+            measure("verlet", h, y0, y_exact, [&] { return velocityVerlet(accel_counted, t0, y0, h, tf); }));
+        rows.push_back(measure("yoshida4", h, y0, y_exact, [&] { return yoshida4(accel_counted, t0, y0, h, tf); }));
+        rows.push_back(measure("abm6", h, y0, y_exact,
+                               [&] { return adamsBashforthMoulton(rhs_counted, t0, y0, h, tf, 6); }));
+    }
+
+    const double rtols[] = {1e-4, 1e-6, 1e-8, 1e-10, 1e-12};
+    for (double rtol : rtols) {
+        AdaptiveOptions opt;
+        opt.atol = opt.rtol = rtol;
+        rows.push_back(
+            measure("dopri5", rtol, y0, y_exact, [&] { return dormandPrince45(rhs_counted, t0, y0, tf, opt); }));
+    }
+
+    // Closed-form propagation: no rhs calls at all
+    rows.push_back(measure("kepler", 0.0, y0, y_exact, [&] { return keplerPropagate(y0, G * M, tf - t0); }));
+
+    ofstream outFile("work_precision.dat");
+    outFile << "method param time_ms rhs_evals pos_error energy_error" << endl;
+    cout << setw(10) << "method" << setw(10) << "param" << setw(12) << "time [ms]" << setw(12) << "rhs evals"
+         << setw(16) << "pos error [m]" << setw(14) << "energy error" << endl;
+    for (const Row &r : rows) {
+        outFile << setprecision(10) << r.method << " " << r.param << " " << r.time_ms << " " << r.evals << " "
+                << r.pos_error << " " << r.energy_error << endl;
+        cout << setprecision(6) << setw(10) << r.method << setw(10) << r.param << setw(12) << r.time_ms << setw(12)
+             << r.evals << setw(16) << r.pos_error << setw(14) << r.energy_error << endl;
+    }
+    outFile.close();
+
+    if (argc > 1) return check_baseline(argv[1], rows);
+    return 0;
+}
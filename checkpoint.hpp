@@ -0,0 +1,312 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "ode.hpp"
+#include "adaptive.hpp"
+#include "multistep.hpp"
+
+/* Checkpoint and restart for long integrations.
+ *
+ * A Checkpoint holds everything a stepper needs to carry on exactly where
+ * it stopped: the time grid (t0 and the step count n) for RK4 and ABM, the
+ * restart point, step proposal and PI controller state for dopri5, and the
+ * derivative history for ABM. The *Checkpointed functions advance a
+ * checkpoint in place to a new tf, writing it to disk every interval
+ * seconds of simulated time and at the end. To extend a run, call them
+ * again with a larger tf (on the same object, or one loaded from the file
+ * after a crash) and only the new part is integrated. Each refuses a
+ * checkpoint made by another method.
+ *
+ * All three continue bit for bit as if never stopped. For dopri5 the step
+ * that landed on the old tf was shortened to hit it, so the run restarts
+ * from the end of the step before it (t_restart, y_restart) with the
+ * controller state of that moment, and redoes that stretch as an
+ * uninterrupted run would; its output resumes after the old tf.
+ *
+ * File layout (native byte order): 8-byte magic "ORBCKPT2", then int32
+ * method and int32 N, then the fields below in order as doubles / int64.
+ * Files are written to path.tmp and renamed, so a crash while saving
+ * leaves the previous checkpoint intact.
+ */
+
+enum class CheckpointMethod : std::int32_t { RK4 = 1, Dopri5 = 2, ABM = 3 };
+
+template <std::size_t N>
+struct Checkpoint {
+    CheckpointMethod method = CheckpointMethod::RK4;
+    double t0 = 0.0; // Start of the step grid (RK4, ABM: t = t0 + n * h)
+    long n = 0;      // Steps taken
+    double t = 0.0;
+    State<N> y{};
+    double h = 0.0; // Fixed step, or dopri5's step to try from t_restart (0 = pick)
+
+    // dopri5: where the next run starts, and the controller state there
+    double t_restart = 0.0;
+    State<N> y_restart{};
+    StepController control;
+    AdaptiveStats stats;
+
+    // ABM
+    int order = 4;
+    bool final_eval = true;
+    DerivativeHistory<N> hist;
+
+    Checkpoint() {}
+    Checkpoint(CheckpointMethod method, double t0, const State<N> &y0, double h = 0.0)
+        : method(method), t0(t0), t(t0), y(y0), h(h), t_restart(t0), y_restart(y0) {}
+};
+
+/* Where and how often to save */
+struct CheckpointOptions {
+    std::string path;      // Empty: keep the checkpoint in memory only
+    double interval = 0.0; // Simulated seconds between saves (0: only at the end)
+};
+
+namespace checkpoint_io {
+const char magic[8] = {'O', 'R', 'B', 'C', 'K', 'P', 'T', '2'};
+
+inline void put(std::ostream &out, double v) { out.write(reinterpret_cast<const char *>(&v), sizeof v); }
+inline void put(std::ostream &out, std::int64_t v) { out.write(reinterpret_cast<const char *>(&v), sizeof v); }
+inline void get(std::istream &in, double &v) { in.read(reinterpret_cast<char *>(&v), sizeof v); }
+inline void get(std::istream &in, std::int64_t &v) { in.read(reinterpret_cast<char *>(&v), sizeof v); }
+} // namespace checkpoint_io
+
+template <std::size_t N>
+bool saveCheckpoint(const std::string &path, const Checkpoint<N> &ck) {
+    using namespace checkpoint_io;
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << "Error opening file: " << tmp << std::endl;
+            return false;
+        }
+        std::int32_t head[2] = {static_cast<std::int32_t>(ck.method), static_cast<std::int32_t>(N)};
+        out.write(magic, sizeof magic);
+        out.write(reinterpret_cast<const char *>(head), sizeof head);
+
+        put(out, ck.t0);
+        put(out, std::int64_t(ck.n));
+        put(out, ck.t);
+        for (double v : ck.y) put(out, v);
+        put(out, ck.h);
+        put(out, ck.t_restart);
+        for (double v : ck.y_restart) put(out, v);
+        put(out, ck.control.err_old);
+        put(out, std::int64_t(ck.control.last_rejected));
+        put(out, std::int64_t(ck.stats.rhs_evals));
+        put(out, std::int64_t(ck.stats.accepted));
+        put(out, std::int64_t(ck.stats.rejected));
+        put(out, std::int64_t(ck.order));
+        put(out, std::int64_t(ck.final_eval));
+        put(out, std::int64_t(ck.hist.head));
+        put(out, std::int64_t(ck.hist.count));
+        for (const State<N> &f : ck.hist.f) {
+            for (double v : f) put(out, v);
+        }
+        if (!out.good()) {
+            std::cerr << "Error writing checkpoint: " << tmp << std::endl;
+            return false;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::cerr << "Error renaming " << tmp << " to " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+template <std::size_t N>
+bool loadCheckpoint(const std::string &path, Checkpoint<N> &ck) {
+    using namespace checkpoint_io;
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false; // No checkpoint yet: not an error
+
+    char m[8];
+    std::int32_t head[2];
+    in.read(m, sizeof m);
+    in.read(reinterpret_cast<char *>(head), sizeof head);
+    if (!in.good() || !std::equal(m, m + 8, magic) || head[1] != static_cast<std::int32_t>(N)) {
+        std::cerr << "Not a checkpoint for this problem: " << path << std::endl;
+        return false;
+    }
+
+    Checkpoint<N> c;
+    std::int64_t n, last_rejected, evals, accepted, rejected, order, final_eval, head_slot, count;
+    c.method = static_cast<CheckpointMethod>(head[0]);
+    get(in, c.t0);
+    get(in, n);
+    get(in, c.t);
+    for (double &v : c.y) get(in, v);
+    get(in, c.h);
+    get(in, c.t_restart);
+    for (double &v : c.y_restart) get(in, v);
+    get(in, c.control.err_old);
+    get(in, last_rejected);
+    get(in, evals);
+    get(in, accepted);
+    get(in, rejected);
+    get(in, order);
+    get(in, final_eval);
+    get(in, head_slot);
+    get(in, count);
+    for (State<N> &f : c.hist.f) {
+        for (double &v : f) get(in, v);
+    }
+    if (!in.good()) {
+        std::cerr << "Truncated checkpoint: " << path << std::endl;
+        return false;
+    }
+    // Everything used as a count or an index must be in range
+    bool known = head[0] >= static_cast<std::int32_t>(CheckpointMethod::RK4) &&
+                 head[0] <= static_cast<std::int32_t>(CheckpointMethod::ABM);
+    if (!known || n < 0 || order < 1 || order > abm_max_order || head_slot < 0 || head_slot >= abm_max_order ||
+        count < 0 || count > abm_max_order) {
+        std::cerr << "Corrupt checkpoint: " << path << std::endl;
+        return false;
+    }
+
+    c.n = n;
+    c.control.last_rejected = last_rejected != 0;
+    c.stats.rhs_evals = evals;
+    c.stats.accepted = accepted;
+    c.stats.rejected = rejected;
+    c.order = static_cast<int>(order);
+    c.final_eval = final_eval != 0;
+    c.hist.head = static_cast<int>(head_slot);
+    c.hist.count = static_cast<int>(count);
+    ck = c;
+    return true;
+}
+
+// False, with a message, if ck was written by another method
+template <std::size_t N>
+bool checkpointIsFor(const Checkpoint<N> &ck, CheckpointMethod method) {
+    if (ck.method == method) return true;
+    std::cerr << "Error: checkpoint was made by method " << static_cast<int>(ck.method) << ", not "
+              << static_cast<int>(method) << std::endl;
+    return false;
+}
+
+/* Saves ck whenever the integration passes the next multiple of interval */
+template <std::size_t N>
+class CheckpointSaver {
+public:
+    CheckpointSaver(const Checkpoint<N> &ck, const CheckpointOptions &opt) : ck(ck), opt(opt) {
+        next = opt.interval > 0.0 ? (std::floor((ck.t - ck.t0) / opt.interval) + 1.0) * opt.interval + ck.t0
+                                  : INFINITY;
+    }
+
+    void check() {
+        if (ck.t < next) return;
+        save();
+        while (next <= ck.t) next += opt.interval;
+    }
+
+    bool save() const { return opt.path.empty() || saveCheckpoint(opt.path, ck); }
+
+private:
+    const Checkpoint<N> &ck;
+    const CheckpointOptions &opt;
+    double next;
+};
+
+// Runge-Kutta 4th order method from a checkpoint to tf
+// ck.h is the step; ck is left at the final state. out(t, y) is called
+// after every step. A checkpoint of another method is left untouched.
+template <std::size_t N, typename Rhs, typename Output = NoOutput>
+State<N> rungeKutta4Checkpointed(Rhs rhs, Checkpoint<N> &ck, double tf,
+                                 const CheckpointOptions &copt = CheckpointOptions(), Output out = Output()) {
+    if (!checkpointIsFor(ck, CheckpointMethod::RK4)) return ck.y;
+    CheckpointSaver<N> saver(ck, copt);
+    auto step = [&](double, const State<N> &, const State<N> &, double t1, const State<N> &y1, const State<N> &) {
+        ck.t = t1;
+        ck.y = y1;
+        ck.n++;
+        out(t1, y1);
+        saver.check();
+        return false;
+    };
+    rungeKutta4Steps(rhs, ck.t0, ck.y, ck.h, tf, step, nullptr, ck.n);
+    saver.save();
+    return ck.y;
+}
+
+// Adaptive Dormand-Prince 5(4) method from a checkpoint to tf
+// Restarts from ck.t_restart (see above); out(t, y) is called for the
+// accepted steps after ck.t. ck.stats.reached_tf is false if
+// opt.max_steps ran out first, with ck at the last accepted step.
+template <std::size_t N, typename Rhs, typename Output = NoOutput>
+State<N> dormandPrince45Checkpointed(Rhs rhs, Checkpoint<N> &ck, double tf,
+                                     const CheckpointOptions &copt = CheckpointOptions(),
+                                     const AdaptiveOptions &opt = AdaptiveOptions(), Output out = Output()) {
+    if (!checkpointIsFor(ck, CheckpointMethod::Dopri5)) return ck.y;
+    if (tf <= ck.t) {
+        ck.stats.reached_tf = true;
+        return ck.y;
+    }
+    CheckpointSaver<N> saver(ck, copt);
+    // Work on copies: ck must only ever hold a consistent accepted state
+    double t = ck.t_restart, h = ck.h;
+    State<N> y = ck.y_restart;
+    StepController control = ck.control;
+    const double t_reported = ck.t;
+    auto step = [&](double, const State<N> &, const State<N> &, double t1, const State<N> &y1, const State<N> &) {
+        // A step landing on tf may have been shortened: restart before it
+        if (t1 < tf) {
+            ck.t_restart = t1;
+            ck.y_restart = y1;
+            ck.h = h;
+            ck.control = control;
+        }
+        if (t1 > t_reported) {
+            ck.t = t1;
+            ck.y = y1;
+            ck.n++;
+            out(t1, y1);
+        }
+        saver.check();
+        return false;
+    };
+    dormandPrince45Advance(rhs, t, y, h, control, tf, step, opt, ck.stats);
+    saver.save();
+    return ck.y;
+}
+
+// Adams-Bashforth-Moulton method from a checkpoint to tf
+// ck.h is the step, ck.order and ck.final_eval as in adamsBashforthMoulton.
+// A checkpoint of another method is left untouched.
+template <std::size_t N, typename Rhs, typename Output = NoOutput>
+State<N> adamsBashforthMoultonCheckpointed(Rhs rhs, Checkpoint<N> &ck, double tf,
+                                           const CheckpointOptions &copt = CheckpointOptions(),
+                                           Output out = Output()) {
+    if (!checkpointIsFor(ck, CheckpointMethod::ABM)) return ck.y;
+    CheckpointSaver<N> saver(ck, copt);
+    // The history is pushed after y is updated, so save from the observer,
+    // which runs once both are consistent
+    State<N> y = ck.y;
+    long n = ck.n;
+    auto observe = [&](double t1, const State<N> &y1) {
+        ck.t = t1;
+        ck.y = y1;
+        ck.n = n;
+        out(t1, y1);
+        saver.check();
+    };
+    ck.stats.rhs_evals +=
+        adamsBashforthMoultonAdvance(rhs, ck.t0, n, y, ck.hist, ck.h, tf, ck.order, ck.final_eval, observe);
+    ck.n = n;
+    ck.y = y;
+    ck.t = ck.t0 + n * ck.h;
+    saver.save();
+    return ck.y;
+}
+
+#endif // CHECKPOINT_HPP
@@ -0,0 +1,88 @@
+#ifndef CONSTELLATION_HPP
+#define CONSTELLATION_HPP
+
+#include <vector>
+#include "orbit.hpp"
+#include "adaptive.hpp"
+#include "events.hpp"
+#include "dense.hpp"
+#include "work_stealing.hpp"
+
+/* Constellation mode: many independent satellites from a list of initial
+ * states, each propagated with adaptive Dormand-Prince 5(4) on its own
+ * core. Trajectories stop at tf or, optionally, when they hit the Earth,
+ * so their cost varies a lot; the work-stealing pool keeps every core busy
+ * until the last one finishes.
+ */
+
+struct ConstellationOptions {
+    AdaptiveOptions adaptive;
+    double dt_out = 0.0;        // Sample every dt_out from t0 + dt_out (0: final states only)
+    bool stop_on_impact = true; // End a trajectory at the Earth's surface
+};
+
+struct OrbitSample {
+    double t;
+    OrbitState y;
+};
+
+struct ConstellationResult {
+    std::vector<OrbitState> final_states;
+    std::vector<double> t_end;    // Time each trajectory stopped
+    std::vector<char> impacted;   // 1 if it hit the Earth (not vector<bool>: threads write neighbours)
+    std::vector<AdaptiveStats> stats;
+    std::vector<std::vector<OrbitSample>> samples; // Empty unless dt_out > 0
+};
+
+// Propagate one satellite; results go to slot i of res
+template <typename Model>
+void propagateSatellite(Model model, const OrbitState &y0, double t0, double tf, const ConstellationOptions &opt,
+                        ConstellationResult &res, std::size_t i) {
+    std::vector<Event<4>> events;
+    if (opt.stop_on_impact) {
+        Event<4> impact;
+        impact.g = event_earth_impact;
+        impact.direction = -1;
+        impact.terminal = true;
+        events.push_back(impact);
+    }
+    EventDetector<4> detector(events);
+    detector.start(t0, y0);
+
+    std::vector<OrbitSample> &samples = res.samples[i];
+    auto record = [&samples](double t, const OrbitState &y) { samples.push_back({t, y}); };
+    DenseSampler<4, decltype(record)> sampler(t0 + opt.dt_out, opt.dt_out, record);
+
+    bool hit = false;
+    auto step = [&](double ta, const OrbitState &ya, const OrbitState &fa, double &tb, OrbitState &yb,
+                    const OrbitState &fb) {
+        double t_full = tb;
+        OrbitState y_full = yb;
+        hit = detector.step(ta, ya, fa, tb, yb, fb);
+        // Sample the full step's interpolant, but not past an impact
+        if (opt.dt_out > 0.0) sampler.sample(ta, ya, fa, t_full, y_full, fb, tb);
+        return hit;
+    };
+
+    res.final_states[i] = dormandPrince45Steps(model, t0, y0, tf, step, &res.t_end[i], opt.adaptive, &res.stats[i]);
+    res.impacted[i] = hit;
+}
+
+// Propagate every satellite in y0 from t0 to tf on the pool's threads
+template <typename Model>
+ConstellationResult propagateConstellation(Model model, const std::vector<OrbitState> &y0, double t0, double tf,
+                                           WorkStealingPool &pool,
+                                           const ConstellationOptions &opt = ConstellationOptions()) {
+    std::size_t n = y0.size();
+    ConstellationResult res;
+    res.final_states.resize(n);
+    res.t_end.resize(n);
+    res.impacted.resize(n);
+    res.stats.resize(n);
+    res.samples.resize(n);
+
+    pool.parallelFor(n, [&](std::size_t i) { propagateSatellite(model, y0[i], t0, tf, opt, res, i); });
+    return res;
+}
+
+#endif // CONSTELLATION_HPP
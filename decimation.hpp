@@ -0,0 +1,227 @@
+#ifndef DECIMATION_HPP
+#define DECIMATION_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ode.hpp"
+#include "trajectory.hpp"
+
+/* Error-bounded decimation of stored trajectories.
+ *
+ * For states laid out as positions then velocities (x, y, vx, vy), the
+ * cubic Hermite through two states, using the velocities as the position
+ * derivatives, reproduces a smooth orbit between them to fourth order.
+ * Decimator sits in front of a writer and keeps a state only when the
+ * Hermite segment from the previous kept state could no longer reproduce
+ * every state emitted in between within the tolerance, so the stored file
+ * holds a few points per orbit instead of every step. The bound is
+ * checked against every state the integrator emitted; readDecimated /
+ * DecimatedTrajectory rebuild the state at any time from the kept ones.
+ */
+
+struct DecimationOptions {
+    double position_tol = 1.0;      // Max position error at a dropped state [m]
+    double velocity_tol = INFINITY; // Max velocity error [m/s] (infinite: positions only)
+    std::size_t max_span = 65536;   // Max states held between kept ones
+};
+
+// Positions (first N/2 components) and velocities (last N/2) at t from
+// the Hermite segment between the states y0 at t0 and y1 at t1
+template <std::size_t N>
+void hermitePositionVelocity(double t0, const State<N> &y0, double t1, const State<N> &y1, double t,
+                             State<N> &y) {
+    const std::size_t D = N / 2;
+    double h = t1 - t0;
+    double s = (t - t0) / h;
+    double s2 = s * s, s3 = s2 * s;
+    double h00 = 2.0 * s3 - 3.0 * s2 + 1.0, d00 = (6.0 * s2 - 6.0 * s) / h;
+    double h10 = (s3 - 2.0 * s2 + s) * h, d10 = 3.0 * s2 - 4.0 * s + 1.0;
+    double h01 = -2.0 * s3 + 3.0 * s2, d01 = -d00;
+    double h11 = (s3 - s2) * h, d11 = 3.0 * s2 - 2.0 * s;
+    for (std::size_t i = 0; i < D; ++i) {
+        y[i] = h00 * y0[i] + h10 * y0[D + i] + h01 * y1[i] + h11 * y1[D + i];
+        y[D + i] = d00 * y0[i] + d10 * y0[D + i] + d01 * y1[i] + d11 * y1[D + i];
+    }
+}
+
+/* Online decimating writer. Takes rows through write(t, y) / output() like
+ * the other writers and passes the kept ones to the Sink, which it owns
+ * and builds from the extra constructor arguments, e.g.
+ * Decimator<4, TrajectoryWriter> out(opt, "rk4_outputDecimated.traj").
+ * It can itself be the sink of an AsyncWriter.
+ *
+ * The states since the last kept one are buffered. The segment ending at
+ * the newest state is re-checked only after the buffer has grown by a
+ * quarter, and when it fails a bisection finds the longest segment that
+ * still passes, so each step costs a few interpolations on average.
+ */
+template <std::size_t N, typename Sink>
+class Decimator {
+    static_assert(N % 2 == 0, "Decimator needs positions followed by velocities");
+
+public:
+    template <typename... Args>
+    explicit Decimator(const DecimationOptions &opt, Args &&...args)
+        : opt(opt), sink(std::forward<Args>(args)...) {}
+
+    ~Decimator() { close(); }
+
+    Decimator(const Decimator &) = delete;
+    Decimator &operator=(const Decimator &) = delete;
+
+    void write(double t, const State<N> &y) {
+        ++seen_;
+        if (!started) {
+            started = true;
+            keep(t, y);
+            return;
+        }
+        times.push_back(t);
+        states.push_back(y);
+        while (times.size() >= next_check || times.size() >= opt.max_span) extend(false);
+    }
+
+    struct Output {
+        Decimator *d;
+        void operator()(double t, const State<N> &y) const { d->write(t, y); }
+    };
+    Output output() { return {this}; }
+
+    // Keep whatever is needed of the buffered states, including the last,
+    // and close the sink
+    bool close() {
+        if (closed) return ok;
+        closed = true;
+        while (!times.empty()) extend(true);
+        ok = sink.close();
+        return ok;
+    }
+
+    std::size_t seen() const { return seen_; }
+    std::size_t kept() const { return kept_; }
+
+private:
+    // Does the segment from the kept state to buffered state e reproduce
+    // buffered states 0 .. e-1?
+    bool fits(std::size_t e) const {
+        State<N> y;
+        for (std::size_t i = 0; i < e; ++i) {
+            hermitePositionVelocity(t_kept, y_kept, times[e], states[e], times[i], y);
+            double dp = 0.0, dv = 0.0;
+            for (std::size_t j = 0; j < N / 2; ++j) {
+                double a = y[j] - states[i][j], b = y[N / 2 + j] - states[i][N / 2 + j];
+                dp += a * a;
+                dv += b * b;
+            }
+            if (dp > opt.position_tol * opt.position_tol || dv > opt.velocity_tol * opt.velocity_tol) return false;
+        }
+        return true;
+    }
+
+    // Check the segment to the newest buffered state; on failure, or when
+    // the buffer is full or flushing, keep the end of the longest passing
+    // segment
+    void extend(bool flush) {
+        std::size_t m = times.size();
+        if (fits(m - 1)) {
+            good = m;
+            if (!flush && m < opt.max_span) {
+                next_check = m + m / 4 + 1;
+                return;
+            }
+        } else {
+            std::size_t lo = good, hi = m; // Prefix lo passes, hi fails
+            while (hi - lo > 1) {
+                std::size_t mid = lo + (hi - lo) / 2;
+                if (fits(mid - 1)) {
+                    lo = mid;
+                } else {
+                    hi = mid;
+                }
+            }
+            good = lo;
+        }
+
+        keep(times[good - 1], states[good - 1]);
+        times.erase(times.begin(), times.begin() + good);
+        states.erase(states.begin(), states.begin() + good);
+        good = times.empty() ? 0 : 1; // A segment with nothing inside always passes
+        next_check = times.size() + times.size() / 4 + 1;
+    }
+
+    void keep(double t, const State<N> &y) {
+        t_kept = t;
+        y_kept = y;
+        ++kept_;
+        sink.write(t, y);
+    }
+
+    DecimationOptions opt;
+    Sink sink;
+    bool started = false, closed = false, ok = true;
+    double t_kept = 0.0;
+    State<N> y_kept{};
+    std::vector<double> times; // Buffered states after the kept one
+    std::vector<State<N>> states;
+    std::size_t good = 0;       // Longest buffer prefix known to pass
+    std::size_t next_check = 1; // Buffer size at which to check again
+    std::size_t seen_ = 0, kept_ = 0;
+};
+
+/* Kept states of a decimated trajectory and reconstruction at any time */
+template <std::size_t N>
+class DecimatedTrajectory {
+public:
+    std::size_t size() const { return times.size(); }
+    double tBegin() const { return times.empty() ? NAN : times.front(); }
+    double tEnd() const { return times.empty() ? NAN : times.back(); }
+
+    // State at t; false if t is outside [tBegin(), tEnd()]
+    bool state(double t, State<N> &y) const {
+        if (times.empty() || !(t >= times.front() && t <= times.back())) return false;
+        std::size_t lo = 0, hi = times.size() - 1;
+        while (hi - lo > 1) { // times[lo] <= t <= times[hi]
+            std::size_t mid = lo + (hi - lo) / 2;
+            if (times[mid] <= t) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        if (t == times[lo] || lo == hi) {
+            y = states[lo];
+        } else if (t == times[hi]) {
+            y = states[hi];
+        } else {
+            hermitePositionVelocity(times[lo], states[lo], times[hi], states[hi], t, y);
+        }
+        return true;
+    }
+
+    std::vector<double> times;
+    std::vector<State<N>> states;
+};
+
+// Read a trajectory file written through a Decimator (columns t, y0 .. yN-1)
+template <std::size_t N>
+bool readDecimated(const std::string &path, DecimatedTrajectory<N> &traj) {
+    Trajectory raw;
+    if (!readTrajectory(path, raw)) return false;
+    if (raw.columns.size() != N + 1) {
+        std::cerr << "Expected " << N + 1 << " columns in " << path << std::endl;
+        return false;
+    }
+    DecimatedTrajectory<N> d;
+    d.times = raw.columns[0];
+    d.states.resize(raw.rows());
+    for (std::size_t r = 0; r < raw.rows(); ++r) {
+        for (std::size_t i = 0; i < N; ++i) d.states[r][i] = raw.columns[i + 1][r];
+    }
+    traj = std::move(d);
+    return true;
+}
+
+#endif // DECIMATION_HPP
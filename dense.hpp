@@ -0,0 +1,80 @@
+#ifndef DENSE_HPP
+#define DENSE_HPP
+
+#include <cmath>
+#include <vector>
+#include "ode.hpp"
+#include "adaptive.hpp"
+
+/* Dense output: states at requested times, independent of the step size.
+ * Each step's cubic Hermite interpolant (built from the states and
+ * derivatives the stepper already has at both ends) is evaluated at every
+ * requested time inside the step, so sampling costs no rhs calls.
+ */
+
+/* Step handler emitting out(t, y) on the grid t_first + k * dt (k = 0, 1,
+ * ...) or on an explicit sorted list of times. Grid times are computed
+ * from k, not accumulated, so they never drift.
+ */
+template <std::size_t N, typename Output>
+class DenseSampler {
+public:
+    DenseSampler(double t_first, double dt, Output out) : t_first(t_first), dt(dt), out(out) {}
+    DenseSampler(std::vector<double> times, Output out) : times(std::move(times)), out(out) {}
+
+    bool operator()(double t0, const State<N> &y0, const State<N> &f0, double t1, const State<N> &y1,
+                    const State<N> &f1) {
+        sample(t0, y0, f0, t1, y1, f1, t1);
+        return false;
+    }
+
+    // Emit the requested times in the step up to t_last <= t1 only, e.g.
+    // when an event ends the integration inside the step
+    void sample(double t0, const State<N> &y0, const State<N> &f0, double t1, const State<N> &y1,
+                const State<N> &f1, double t_last) {
+        State<N> y;
+        for (double t = next(); t <= t_last; t = next()) {
+            if (t < t0) { // Requested before the integration started
+                ++k;
+                continue;
+            }
+            if (t == t1) {
+                y = y1;
+            } else {
+                hermiteInterpolate(t0, y0, f0, t1, y1, f1, t, y);
+            }
+            out(t, y);
+            ++k;
+        }
+    }
+
+private:
+    double next() const {
+        if (!times.empty()) return k < times.size() ? times[k] : INFINITY;
+        return t_first + static_cast<double>(k) * dt;
+    }
+
+    double t_first = 0.0, dt = 0.0;
+    std::vector<double> times;
+    std::size_t k = 0;
+    Output out;
+};
+
+// Runge-Kutta 4th order method with output every dt_out from t0 + dt_out
+template <std::size_t N, typename Rhs, typename Output>
+State<N> rungeKutta4Dense(Rhs rhs, double t0, const State<N> &y0, double h, double tf, double dt_out,
+                          Output out) {
+    DenseSampler<N, Output> sampler(t0 + dt_out, dt_out, out);
+    return rungeKutta4Steps(rhs, t0, y0, h, tf, sampler);
+}
+
+// Adaptive Dormand-Prince 5(4) method with output every dt_out from t0 + dt_out
+template <std::size_t N, typename Rhs, typename Output>
+State<N> dormandPrince45Dense(Rhs rhs, double t0, const State<N> &y0, double tf, double dt_out,
+                              Output out, const AdaptiveOptions &opt = AdaptiveOptions(),
+                              AdaptiveStats *stats = nullptr) {
+    DenseSampler<N, Output> sampler(t0 + dt_out, dt_out, out);
+    return dormandPrince45Steps(rhs, t0, y0, tf, sampler, nullptr, opt, stats);
+}
+
+#endif // DENSE_HPP
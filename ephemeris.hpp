@@ -0,0 +1,209 @@
+#ifndef EPHEMERIS_HPP
+#define EPHEMERIS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "orbit.hpp"
+
+/* Moving Moon (and Sun) for the Earth-centred problems.
+ *
+ * lunarPosition/solarPosition evaluate a truncated analytic theory (mean
+ * elements plus the largest periodic terms, projected on the ecliptic
+ * plane). That costs a dozen sin/cos per call, too much for every RK
+ * stage, so ChebyshevEphemeris samples it once over the simulation window
+ * into fixed-length segments of Chebyshev coefficients. A query is then
+ * one division to find the segment and a short Clenshaw recurrence, with
+ * all coefficients of a segment next to each other in memory.
+ *
+ * Times are seconds; the theories take seconds since J2000.0 and the
+ * ephemeris maps simulation time t to epoch + t.
+ */
+
+constexpr double deg_to_rad = M_PI / 180.0;
+constexpr double seconds_per_day = 86400.0;
+constexpr double astronomical_unit = 1.495978707e11; // meters
+
+// Geocentric Moon position in meters, t in seconds since J2000.0
+// Main terms of the lunar longitude and distance series (evection,
+// variation, annual equation); good to a few hundred kilometres.
+inline void lunarPosition(double t, State<2> &r) {
+    double d = t / seconds_per_day;
+    double L = (218.3165 + 13.176396 * d) * deg_to_rad;  // Mean longitude
+    double Mm = (134.9634 + 13.064993 * d) * deg_to_rad; // Mean anomaly
+    double D = (297.8502 + 12.190749 * d) * deg_to_rad;  // Mean elongation from the Sun
+    double Ms = (357.5291 + 0.985600 * d) * deg_to_rad;  // Sun's mean anomaly
+
+    double lon = L + (6.289 * std::sin(Mm) + 1.274 * std::sin(2.0 * D - Mm) + 0.658 * std::sin(2.0 * D) +
+                      0.214 * std::sin(2.0 * Mm) - 0.186 * std::sin(Ms)) * deg_to_rad;
+    double dist = (385001.0 - 20905.0 * std::cos(Mm) - 3699.0 * std::cos(2.0 * D - Mm) -
+                   2956.0 * std::cos(2.0 * D) - 570.0 * std::cos(2.0 * Mm)) * 1000.0;
+
+    r[0] = dist * std::cos(lon);
+    r[1] = dist * std::sin(lon);
+}
+
+// Geocentric Sun position in meters, t in seconds since J2000.0
+inline void solarPosition(double t, State<2> &r) {
+    double d = t / seconds_per_day;
+    double L = (280.460 + 0.9856474 * d) * deg_to_rad; // Mean longitude
+    double g = (357.528 + 0.9856003 * d) * deg_to_rad; // Mean anomaly
+
+    double lon = L + (1.915 * std::sin(g) + 0.020 * std::sin(2.0 * g)) * deg_to_rad;
+    double dist = (1.00014 - 0.01671 * std::cos(g) - 0.00014 * std::cos(2.0 * g)) * astronomical_unit;
+
+    r[0] = dist * std::cos(lon);
+    r[1] = dist * std::sin(lon);
+}
+
+/* Piecewise Chebyshev fit of a planar position over [t_begin, t_end].
+ * Segment k covers [t_begin + k * span, t_begin + (k + 1) * span]; its
+ * coefficients for x and then y are stored contiguously. Queries outside
+ * the window use the first or last segment (extrapolation).
+ */
+class ChebyshevEphemeris {
+public:
+    ChebyshevEphemeris() {}
+
+    // Fit f(t, r) with span-second segments of the given degree
+    template <typename F>
+    ChebyshevEphemeris(F f, double t_begin, double t_end, double span = seconds_per_day, int degree = 8)
+        : t_begin(t_begin), span(span), inv_span(1.0 / span), n(degree + 1) {
+        segments = std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil((t_end - t_begin) / span)));
+        coef.resize(segments * 2 * n);
+
+        // Interpolate at the n Chebyshev nodes of each segment
+        std::vector<State<2>> samples(n);
+        for (std::size_t k = 0; k < segments; ++k) {
+            double ta = t_begin + static_cast<double>(k) * span;
+            for (int j = 0; j < n; ++j) {
+                double tau = std::cos(M_PI * (j + 0.5) / n);
+                f(ta + 0.5 * (tau + 1.0) * span, samples[j]);
+            }
+            for (int c = 0; c < 2; ++c) {
+                double *a = &coef[(k * 2 + c) * n];
+                for (int i = 0; i < n; ++i) {
+                    double sum = 0.0;
+                    for (int j = 0; j < n; ++j) sum += samples[j][c] * std::cos(M_PI * i * (j + 0.5) / n);
+                    a[i] = (i == 0 ? 1.0 : 2.0) * sum / n;
+                }
+            }
+        }
+
+        // Worst fit error, checked halfway between the nodes
+        for (std::size_t k = 0; k < segments; ++k) {
+            double ta = t_begin + static_cast<double>(k) * span;
+            for (int j = 0; j <= 2 * n; ++j) {
+                double t = ta + span * j / (2.0 * n);
+                State<2> exact, fit;
+                f(t, exact);
+                position(t, fit);
+                max_error = std::max(max_error, std::hypot(fit[0] - exact[0], fit[1] - exact[1]));
+            }
+        }
+    }
+
+    // Position at time t
+    // x and y run through the Clenshaw recurrence together, so the two
+    // dependency chains overlap instead of running back to back.
+    void position(double t, State<2> &r) const {
+        double s = (t - t_begin) * inv_span;
+        std::size_t k = 0;
+        if (s > 0.0) k = std::min(static_cast<std::size_t>(s), segments - 1);
+        double tau = 2.0 * (s - static_cast<double>(k)) - 1.0;
+        double tau2 = 2.0 * tau;
+
+        const double *ax = &coef[k * 2 * n];
+        const double *ay = ax + n;
+        double bx1 = 0.0, bx2 = 0.0, by1 = 0.0, by2 = 0.0;
+        for (int i = n - 1; i > 0; --i) {
+            double bx0 = ax[i] + tau2 * bx1 - bx2;
+            double by0 = ay[i] + tau2 * by1 - by2;
+            bx2 = bx1;
+            bx1 = bx0;
+            by2 = by1;
+            by1 = by0;
+        }
+        r[0] = ax[0] + tau * bx1 - bx2;
+        r[1] = ay[0] + tau * by1 - by2;
+    }
+
+    double maxError() const { return max_error; }
+    std::size_t size() const { return segments; }
+
+private:
+    double t_begin = 0.0, span = seconds_per_day, inv_span = 1.0 / seconds_per_day;
+    int n = 0;
+    std::size_t segments = 0;
+    std::vector<double> coef;
+    double max_error = 0.0;
+};
+
+// Moon ephemeris over simulation times [t0, tf], t = 0 at the given epoch
+// One-day segments of degree 8 fit the theory to about a micrometre.
+inline ChebyshevEphemeris moonEphemeris(double t0, double tf, double epoch = 0.0) {
+    return ChebyshevEphemeris([epoch](double t, State<2> &r) { lunarPosition(epoch + t, r); }, t0, tf);
+}
+
+// Sun ephemeris: it moves slowly, so ten-day segments of degree 6 are enough
+inline ChebyshevEphemeris sunEphemeris(double t0, double tf, double epoch = 0.0) {
+    return ChebyshevEphemeris([epoch](double t, State<2> &r) { solarPosition(epoch + t, r); }, t0, tf,
+                              10.0 * seconds_per_day, 6);
+}
+
+/* Earth plus a moving Moon (and optionally the Sun) read from ephemerides.
+ * The frame is centred on the Earth, which is itself pulled by the Moon
+ * and Sun, so each third body contributes its direct pull on the
+ * satellite minus its pull on the Earth (the indirect term).
+ */
+struct MovingMoonModel {
+    static constexpr std::size_t dim = 4;
+    static constexpr double GM = G * M;
+    static constexpr double GM_L = G * ML;
+    static constexpr double GM_S = G * MS;
+
+    const ChebyshevEphemeris *moon;
+    const ChebyshevEphemeris *sun;
+
+    explicit MovingMoonModel(const ChebyshevEphemeris &moon, const ChebyshevEphemeris *sun = nullptr)
+        : moon(&moon), sun(sun) {}
+
+    void accel(double t, const State<2> &q, State<2> &a) const {
+        double r2 = q[0] * q[0] + q[1] * q[1];
+        double r_cubed = r2 * std::sqrt(r2);
+        a[0] = -GM * q[0] / r_cubed;
+        a[1] = -GM * q[1] / r_cubed;
+
+        State<2> rb;
+        moon->position(t, rb);
+        thirdBody(GM_L, rb, q, a);
+        if (sun) {
+            sun->position(t, rb);
+            thirdBody(GM_S, rb, q, a);
+        }
+    }
+
+    void operator()(double t, const OrbitState &yvec, OrbitState &dydt) const {
+        State<2> a;
+        accel(t, {yvec[0], yvec[1]}, a);
+        dydt[0] = yvec[2];
+        dydt[1] = yvec[3];
+        dydt[2] = a[0];
+        dydt[3] = a[1];
+    }
+
+private:
+    static void thirdBody(double GMb, const State<2> &rb, const State<2> &q, State<2> &a) {
+        double dx = q[0] - rb[0];
+        double dy = q[1] - rb[1];
+        double d2 = dx * dx + dy * dy;
+        double d_cubed = d2 * std::sqrt(d2);
+        double b2 = rb[0] * rb[0] + rb[1] * rb[1];
+        double b_cubed = b2 * std::sqrt(b2);
+
+        a[0] -= GMb * (dx / d_cubed + rb[0] / b_cubed);
+        a[1] -= GMb * (dy / d_cubed + rb[1] / b_cubed);
+    }
+};
+
+#endif // EPHEMERIS_HPP
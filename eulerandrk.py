@@ -1,14 +1,15 @@
 import numpy as np
 import matplotlib.pyplot as plt
+from trajectory import load_columns
 
 # Load data from the Euler output file
-euler_data = np.loadtxt("euler_output.dat")
+euler_data = load_columns("euler_output.traj")
 euler_t = euler_data[:, 0]  # Time
 euler_x = euler_data[:, 1]  # x position
 euler_y = euler_data[:, 2]  # y position
 
 # Load data from the RK4 output file
-rk4_data = np.loadtxt("rk4_output.dat")
+rk4_data = load_columns("rk4_output.traj")
 rk4_t = rk4_data[:, 0]  # Time
 rk4_x = rk4_data[:, 1]  # x position
 rk4_y = rk4_data[:, 2]  # y position
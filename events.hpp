@@ -0,0 +1,160 @@
+#ifndef EVENTS_HPP
+#define EVENTS_HPP
+
+#include <cmath>
+#include <functional>
+#include <vector>
+#include "ode.hpp"
+#include "adaptive.hpp"
+
+/* Event detection for the steppers. An event is a scalar function g(t, y)
+ * whose zero crossings mark something of interest (reaching the Moon's x,
+ * periapsis, hitting the Earth). After every step the sign of g is checked;
+ * on a change the crossing time is refined on the Hermite interpolant of
+ * the step, so no extra rhs calls are needed.
+ */
+template <std::size_t N>
+struct Event {
+    std::function<double(double t, const State<N> &y)> g;
+    int direction = 0;     // +1: only rising crossings, -1: only falling, 0: both
+    bool terminal = false; // Stop the integration at the first crossing
+    double t_tol = 1e-6;   // Tolerance on the crossing time in seconds
+};
+
+/* A located crossing */
+template <std::size_t N>
+struct EventHit {
+    std::size_t event; // Index into the detector's event list
+    double t;
+    State<N> y;
+};
+
+template <std::size_t N>
+class EventDetector {
+public:
+    std::vector<Event<N>> events;
+    std::vector<EventHit<N>> hits; // Every crossing found, in time order
+
+    EventDetector() = default;
+    explicit EventDetector(std::vector<Event<N>> ev) : events(std::move(ev)) {}
+
+    // Evaluate all g at the initial point
+    void start(double t0, const State<N> &y0) {
+        hits.clear();
+        g_prev.resize(events.size());
+        for (std::size_t k = 0; k < events.size(); ++k) g_prev[k] = events[k].g(t0, y0);
+    }
+
+    /* Check the step (t0, y0, f0) -> (t1, y1, f1). Crossings inside the step
+     * are appended to hits. Returns true if a terminal event fired; then
+     * (t1, y1) is overwritten with the earliest terminal crossing.
+     */
+    bool step(double t0, const State<N> &y0, const State<N> &f0, double &t1, State<N> &y1, const State<N> &f1) {
+        std::size_t first_hit = hits.size();
+        double t_stop = t1;
+        State<N> y_stop = y1;
+        bool stop = false;
+
+        for (std::size_t k = 0; k < events.size(); ++k) {
+            const Event<N> &ev = events[k];
+            double ga = g_prev[k];
+            double gb = ev.g(t1, y1);
+            g_prev[k] = gb;
+
+            bool rising = ga < 0.0 && gb >= 0.0;
+            bool falling = ga > 0.0 && gb <= 0.0;
+            if (!(rising && ev.direction >= 0) && !(falling && ev.direction <= 0)) continue;
+
+            EventHit<N> hit;
+            hit.event = k;
+            hit.t = locate(ev, t0, y0, f0, t1, y1, f1, ga, gb, hit.y);
+            hits.push_back(hit);
+
+            if (ev.terminal && hit.t <= t_stop) {
+                t_stop = hit.t;
+                y_stop = hit.y;
+                stop = true;
+            }
+        }
+
+        // Keep the hits of this step in time order
+        for (std::size_t i = first_hit + 1; i < hits.size(); ++i) {
+            for (std::size_t j = i; j > first_hit && hits[j].t < hits[j - 1].t; --j) std::swap(hits[j], hits[j - 1]);
+        }
+
+        if (stop) {
+            // Drop crossings after the terminal one
+            while (hits.size() > first_hit && hits.back().t > t_stop) hits.pop_back();
+            t1 = t_stop;
+            y1 = y_stop;
+        }
+        return stop;
+    }
+
+private:
+    // Illinois (modified regula falsi) on g along the Hermite interpolant
+    double locate(const Event<N> &ev, double t0, const State<N> &y0, const State<N> &f0, double t1,
+                  const State<N> &y1, const State<N> &f1, double ga, double gb, State<N> &y) const {
+        double a = t0, b = t1;
+        int side = 0;
+        for (int it = 0; it < 100 && b - a > ev.t_tol; ++it) {
+            double c = (a * gb - b * ga) / (gb - ga);
+            hermiteInterpolate(t0, y0, f0, t1, y1, f1, c, y);
+            double gc = ev.g(c, y);
+            if ((gc < 0.0) == (gb < 0.0) && gc != 0.0) {
+                b = c;
+                gb = gc;
+                if (side == -1) ga /= 2.0;
+                side = -1;
+            } else if (gc == 0.0) {
+                a = b = c;
+            } else {
+                a = c;
+                ga = gc;
+                if (side == +1) gb /= 2.0;
+                side = +1;
+            }
+        }
+        // Report the point on the far side of the crossing
+        hermiteInterpolate(t0, y0, f0, t1, y1, f1, b, y);
+        return b;
+    }
+
+    std::vector<double> g_prev;
+};
+
+// Runge-Kutta 4th order method with event detection
+// Integrates until tf or the first terminal event and returns the state
+// there; t_end receives the time actually reached. Events cost no extra
+// rhs calls beyond the one rungeKutta4Steps makes at the very end.
+template <std::size_t N, typename Rhs, typename Output = NoOutput>
+State<N> rungeKutta4Events(Rhs rhs, double t0, const State<N> &y0, double h, double tf,
+                           EventDetector<N> &detector, double *t_end = nullptr, Output out = Output()) {
+    detector.start(t0, y0);
+    auto step = [&](double ta, const State<N> &ya, const State<N> &fa, double &tb, State<N> &yb,
+                    const State<N> &fb) {
+        bool stop = detector.step(ta, ya, fa, tb, yb, fb);
+        out(tb, yb);
+        return stop;
+    };
+    return rungeKutta4Steps(rhs, t0, y0, h, tf, step, t_end);
+}
+
+// Adaptive Dormand-Prince 5(4) method with event detection
+// Same contract as the RK4 version above.
+template <std::size_t N, typename Rhs, typename Output = NoOutput>
+State<N> dormandPrince45Events(Rhs rhs, double t0, const State<N> &y0, double tf,
+                               EventDetector<N> &detector, double *t_end = nullptr,
+                               const AdaptiveOptions &opt = AdaptiveOptions(), AdaptiveStats *stats = nullptr,
+                               Output out = Output()) {
+    detector.start(t0, y0);
+    auto step = [&](double ta, const State<N> &ya, const State<N> &fa, double &tb, State<N> &yb,
+                    const State<N> &fb) {
+        bool stop = detector.step(ta, ya, fa, tb, yb, fb);
+        out(tb, yb);
+        return stop;
+    };
+    return dormandPrince45Steps(rhs, t0, y0, tf, step, t_end, opt, stats);
+}
+
+#endif // EVENTS_HPP
@@ -0,0 +1,266 @@
+#ifndef INSTRUMENT_HPP
+#define INSTRUMENT_HPP
+
+#include <chrono>
+#include <cmath>
+#include <ostream>
+#include <string>
+#include <utility>
+#include "adaptive.hpp"
+
+/* Integrator statistics: rhs evaluations, steps, rejected steps, min/max
+ * step size, and optionally where the time goes (rhs, output, and the
+ * stepper's own bookkeeping as the rest).
+ *
+ * Nothing in the steppers changes. The rhs (or accel) and the observer or
+ * step handler are wrapped before they are passed in, and the run is
+ * wrapped to time it:
+ *
+ *   IntegratorStats st;
+ *   y = instrumentedRun(st, [&] {
+ *       return rungeKutta4(instrumentRhs(rhs, st), t0, y0, h, tf, instrumentStepOutput(out, st, t0));
+ *   });
+ *   writeStatsJson(cout, "rk4", st);
+ *
+ * Statistics are compiled in only with -DORBIT_STATS. Without it the
+ * wrappers return their argument unchanged, so the steppers are
+ * instantiated with the very same types and the hot loop is identical;
+ * st stays zero and IntegratorStats::enabled is false.
+ *
+ * Steps and their sizes are counted where the stepper reports a step:
+ * instrumentSteps wraps a step handler (rungeKutta4Steps,
+ * dormandPrince45Steps / Advance, and so the dense output built on them),
+ * and instrumentStepOutput an observer that is called once per step
+ * (euler, rungeKutta4, dormandPrince45). instrumentOutput wraps any other
+ * observer, e.g. one fed at dense output times, and counts its calls
+ * only. Rejected steps come from AdaptiveStats.
+ *
+ * By default the wrappers only count. Set st.timed to also time every rhs
+ * and output call: reading the clock costs about as much as an orbit rhs,
+ * so its cost is taken out of each timed call and, for the reads added,
+ * out of the run's total. instrumentedRun calibrates it at the start of
+ * every run as the fastest of several batches of reads, so a cold first
+ * call or a busy moment does not inflate it, and the JSON reports the
+ * amount taken out as clock_overhead_s.
+ */
+
+#ifdef ORBIT_STATS
+#define ORBIT_STATS_ENABLED true
+#else
+#define ORBIT_STATS_ENABLED false
+#endif
+
+struct IntegratorStats {
+    static constexpr bool enabled = ORBIT_STATS_ENABLED;
+
+    bool timed = false; // Time each rhs and output call (two clock reads each)
+
+    long rhs_evals = 0;
+    long steps = 0;    // Accepted steps
+    long rejected = 0; // From AdaptiveStats
+    long outputs = 0;  // Observer or step handler calls
+    double h_min = INFINITY, h_max = 0.0;
+    double total_s = 0.0, rhs_s = 0.0, output_s = 0.0;
+    double t_last = NAN;  // End of the previous step, for instrumentStepOutput
+    long clock_reads = 0;    // Added by the wrappers, taken out of total_s
+    double clock_cost = 0.0; // Seconds per read, calibrated by instrumentedRun
+
+    // Time of the runs, never less than the rhs and output time it
+    // contains; NaN outside an instrumentedRun
+    double totalSeconds() const {
+        if (total_s <= 0.0) return NAN;
+        double parts = timed ? rhs_s + output_s : 0.0;
+        return total_s > parts ? total_s : parts;
+    }
+
+    // Time outside the rhs and output; NaN unless the calls were timed
+    // within an instrumentedRun
+    double bookkeepingSeconds() const {
+        if (!timed || total_s <= 0.0) return NAN;
+        return totalSeconds() - rhs_s - output_s;
+    }
+
+    // Rejections of an adaptive run
+    void add(const AdaptiveStats &a) {
+        if (enabled) rejected += a.rejected;
+    }
+
+    void step(double t0, double t1) {
+        double h = std::fabs(t1 - t0);
+        if (h < h_min) h_min = h;
+        if (h > h_max) h_max = h;
+        ++steps;
+    }
+};
+
+namespace stats_detail {
+using clock = std::chrono::steady_clock;
+
+inline double since(clock::time_point start) {
+    return std::chrono::duration<double>(clock::now() - start).count();
+}
+
+// Seconds per clock read: the fastest of several batches, since a cold
+// first call or a busy moment can only make a batch slower
+inline double clockCost() {
+    const int reads = 100, batches = 20;
+    double best = INFINITY;
+    clock::now(); // Warm up
+    for (int b = 0; b < batches; ++b) {
+        auto start = clock::now();
+        for (int i = 0; i < reads; ++i) clock::now();
+        double s = since(start) / (reads + 1);
+        if (s < best) best = s;
+    }
+    return best;
+}
+
+// Calls f(), adding its time to seconds when st.timed
+template <typename F>
+auto timedCall(IntegratorStats &st, double &seconds, F &&f) -> decltype(f()) {
+    if (!st.timed) return f();
+    struct Stop { // Also for calls returning void or a value
+        IntegratorStats &st;
+        double &seconds;
+        clock::time_point start;
+        ~Stop() {
+            st.clock_reads += 2;
+            double s = since(start) - st.clock_cost;
+            seconds += s > 0.0 ? s : 0.0;
+        }
+    } stop{st, seconds, clock::now()};
+    return f();
+}
+} // namespace stats_detail
+
+// Counts (and with st.timed, times) every call of an rhs or accel
+template <typename Rhs>
+struct CountingRhs {
+    Rhs rhs;
+    IntegratorStats *st;
+
+    template <typename... Args>
+    void operator()(Args &&...args) const {
+        ++st->rhs_evals;
+        stats_detail::timedCall(*st, st->rhs_s, [&] { rhs(std::forward<Args>(args)...); });
+    }
+};
+
+// Counts the calls of an observer; with per_step, one call per step, so
+// also counts steps and their size
+template <typename Output>
+struct CountingOutput {
+    Output out;
+    IntegratorStats *st;
+    bool per_step;
+
+    template <typename Time, typename S>
+    void operator()(Time t, const S &y) {
+        if (per_step) {
+            double t1 = static_cast<double>(t);
+            if (!std::isnan(st->t_last)) st->step(st->t_last, t1);
+            st->t_last = t1;
+        }
+        ++st->outputs;
+        stats_detail::timedCall(*st, st->output_s, [&] { out(t, y); });
+    }
+};
+
+// Counts steps and their size from a step handler's (t0, t1)
+template <typename Step>
+struct CountingSteps {
+    Step step;
+    IntegratorStats *st;
+
+    template <typename S>
+    bool operator()(double t0, const S &y0, const S &f0, double t1, const S &y1, const S &f1) {
+        st->step(t0, t1);
+        ++st->outputs;
+        return stats_detail::timedCall(*st, st->output_s, [&] { return step(t0, y0, f0, t1, y1, f1); });
+    }
+};
+
+#ifdef ORBIT_STATS
+template <typename Rhs>
+CountingRhs<Rhs> instrumentRhs(Rhs rhs, IntegratorStats &st) {
+    return {rhs, &st};
+}
+
+template <typename Output>
+CountingOutput<Output> instrumentOutput(Output out, IntegratorStats &st) {
+    return {out, &st, false};
+}
+
+// For an observer called after every step; t0 is where the integration
+// starts, for the size of the first step
+template <typename Output>
+CountingOutput<Output> instrumentStepOutput(Output out, IntegratorStats &st, double t0) {
+    st.t_last = t0;
+    return {out, &st, true};
+}
+
+template <typename Step>
+CountingSteps<Step> instrumentSteps(Step step, IntegratorStats &st) {
+    return {step, &st};
+}
+
+template <typename Run>
+auto instrumentedRun(IntegratorStats &st, Run run) -> decltype(run()) {
+    if (st.timed) st.clock_cost = stats_detail::clockCost(); // Outside the timed run
+    struct Stop { // Also for runs returning void
+        IntegratorStats &st;
+        long reads;
+        stats_detail::clock::time_point start;
+        ~Stop() {
+            double s = stats_detail::since(start) - (st.clock_reads - reads) * st.clock_cost;
+            st.total_s += s > 0.0 ? s : 0.0;
+        }
+    } stop{st, st.clock_reads, stats_detail::clock::now()};
+    return run();
+}
+#else
+template <typename Rhs>
+Rhs instrumentRhs(Rhs rhs, IntegratorStats &) {
+    return rhs;
+}
+
+template <typename Output>
+Output instrumentOutput(Output out, IntegratorStats &) {
+    return out;
+}
+
+template <typename Output>
+Output instrumentStepOutput(Output out, IntegratorStats &, double) {
+    return out;
+}
+
+template <typename Step>
+Step instrumentSteps(Step step, IntegratorStats &) {
+    return step;
+}
+
+template <typename Run>
+auto instrumentedRun(IntegratorStats &, Run run) -> decltype(run()) {
+    return run();
+}
+#endif
+
+// One JSON object with the statistics of a run
+inline void writeStatsJson(std::ostream &out, const std::string &name, const IntegratorStats &st) {
+    auto num = [&](double v) -> std::ostream & {
+        if (std::isfinite(v)) return out << v;
+        return out << "null";
+    };
+    out << "{\"name\": \"" << name << "\", \"enabled\": " << (st.enabled ? "true" : "false")
+        << ", \"rhs_evals\": " << st.rhs_evals << ", \"steps\": " << st.steps << ", \"rejected\": " << st.rejected
+        << ", \"outputs\": " << st.outputs << ", \"h_min\": ";
+    num(st.steps > 0 ? st.h_min : NAN) << ", \"h_max\": ";
+    num(st.steps > 0 ? st.h_max : NAN) << ", \"total_s\": ";
+    num(st.totalSeconds()) << ", \"rhs_s\": ";
+    num(st.timed ? st.rhs_s : NAN) << ", \"output_s\": ";
+    num(st.timed ? st.output_s : NAN) << ", \"bookkeeping_s\": ";
+    num(st.bookkeepingSeconds()) << ", \"clock_overhead_s\": ";
+    num(st.timed ? st.clock_reads * st.clock_cost : NAN) << "}";
+}
+
+#endif // INSTRUMENT_HPP
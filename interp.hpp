@@ -1,8 +1,23 @@
 #ifndef INTERP_HPP
 #define INTERP_HPP
 
+#include <cstddef>
 #include <valarray>
 
-double lagrange_interp(const std::valarray<double>& x, const std::valarray<double>& y, double x_val);
+/* Function to perform Lagrange interpolation for given data points */
+inline double lagrange_interp(const std::valarray<double>& x, const std::valarray<double>& y, double x_val) {
+    double result = 0.0;
+    std::size_t n = x.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        double term = y[i];
+        for (std::size_t j = 0; j < n; ++j) {
+            if (j != i) {
+                term *= (x_val - x[j]) / (x[i] - x[j]);
+            }
+        }
+        result += term;
+    }
+    return result;
+}
 
 #endif // INTERP_HPP
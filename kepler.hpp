@@ -0,0 +1,140 @@
+#ifndef KEPLER_HPP
+#define KEPLER_HPP
+
+#include <cmath>
+#include <vector>
+#include "ode.hpp"
+
+/* Closed-form two-body propagation: the exact solution of the Earth-only
+ * rhs at any time in O(1), with no stepping. State layout is x, y, vx, vy.
+ *
+ * Uses the universal-variable formulation, so elliptic, parabolic and
+ * hyperbolic orbits are handled alike. For a time offset dt we solve
+ *   sqrt(GM) dt = sigma0 chi^2 C(z) + (1 - alpha r0) chi^3 S(z) + r0 chi
+ * for chi by Newton's method, where z = alpha chi^2, alpha = 1 / a and
+ * sigma0 = r0.v0 / sqrt(GM), then apply the Lagrange f and g coefficients.
+ */
+
+/* Stumpff functions C(z) and S(z), with series near z = 0 */
+inline void stumpff(double z, double &C, double &S) {
+    if (z > 1e-3) {
+        double sz = std::sqrt(z);
+        C = (1.0 - std::cos(sz)) / z;
+        S = (sz - std::sin(sz)) / (sz * z);
+    } else if (z < -1e-3) {
+        double sz = std::sqrt(-z);
+        C = (std::cosh(sz) - 1.0) / (-z);
+        S = (std::sinh(sz) - sz) / (sz * -z);
+    } else {
+        C = 1.0 / 2.0 - z / 24.0 + z * z / 720.0 - z * z * z / 40320.0;
+        S = 1.0 / 6.0 - z / 120.0 + z * z / 5040.0 - z * z * z / 362880.0;
+    }
+}
+
+class KeplerOrbit {
+public:
+    // Orbit through state y0 at time t0 around a body with parameter GM
+    KeplerOrbit(const State<4> &y0, double GM, double t0 = 0.0) : y0(y0), GM(GM), t0(t0) {
+        sqrt_mu = std::sqrt(GM);
+        r0 = std::sqrt(y0[0] * y0[0] + y0[1] * y0[1]);
+        double v2 = y0[2] * y0[2] + y0[3] * y0[3];
+        alpha = 2.0 / r0 - v2 / GM;
+        sigma0 = (y0[0] * y0[2] + y0[1] * y0[3]) / sqrt_mu;
+        period = alpha > 0.0 ? 2.0 * M_PI / std::sqrt(GM * alpha * alpha * alpha) : 0.0;
+    }
+
+    // State at time t
+    State<4> state(double t) const {
+        double chi = initialGuess(reduce(t - t0));
+        return stateFrom(t, chi);
+    }
+
+    /* States at many times. Each solve is warm-started from the previous
+     * one, so sorted times converge in one or two Newton iterations.
+     */
+    void states(const std::vector<double> &times, std::vector<State<4>> &out) const {
+        out.resize(times.size());
+        double dt_prev = 0.0, chi_prev = 0.0;
+        for (std::size_t k = 0; k < times.size(); ++k) {
+            double dt = reduce(times[k] - t0);
+            double chi;
+            if (k > 0 && alpha > 0.0 && std::fabs(dt - dt_prev) < 0.25 * period) {
+                // Extrapolate along dchi/dt = sqrt(GM) / r
+                double rp = std::sqrt(out[k - 1][0] * out[k - 1][0] + out[k - 1][1] * out[k - 1][1]);
+                chi = chi_prev + sqrt_mu / rp * (dt - dt_prev);
+            } else {
+                chi = initialGuess(dt);
+            }
+            out[k] = stateFrom(times[k], chi, &chi_prev);
+            dt_prev = dt;
+        }
+    }
+
+    double getPeriod() const { return period; } // 0 for unbound orbits
+
+private:
+    // For bound orbits only the time within the current revolution matters
+    double reduce(double dt) const {
+        if (alpha > 0.0) {
+            dt = std::fmod(dt, period);
+            if (dt < 0.0) dt += period;
+        }
+        return dt;
+    }
+
+    double initialGuess(double dt) const {
+        if (alpha > 1e-12) return sqrt_mu * dt * alpha;
+        if (alpha < -1e-12) {
+            // Hyperbolic guess (Vallado)
+            double a = 1.0 / alpha;
+            double s = dt > 0.0 ? 1.0 : -1.0;
+            double arg = -2.0 * GM * alpha * dt /
+                         (sigma0 * sqrt_mu + s * std::sqrt(-GM * a) * (1.0 - r0 * alpha));
+            // At dt = 0 (and if the denominator vanishes) the log has no
+            // finite value; the parabolic guess below is used instead
+            if (std::isfinite(arg) && arg != 0.0) return s * std::sqrt(-a) * std::log(std::fabs(arg));
+        }
+        return sqrt_mu * dt / r0;
+    }
+
+    // Newton solve for chi from the guess, then f and g
+    State<4> stateFrom(double t, double chi, double *chi_out = nullptr) const {
+        double dt = reduce(t - t0);
+        double C = 0.5, S = 1.0 / 6.0, r = r0;
+        for (int it = 0; it < 50; ++it) {
+            double chi2 = chi * chi;
+            double z = alpha * chi2;
+            stumpff(z, C, S);
+            double F = sigma0 * chi2 * C + (1.0 - alpha * r0) * chi2 * chi * S + r0 * chi - sqrt_mu * dt;
+            r = sigma0 * chi * (1.0 - z * S) + (1.0 - alpha * r0) * chi2 * C + r0; // dF/dchi
+            double step = F / r;
+            chi -= step;
+            if (std::fabs(step) <= 1e-13 * (1.0 + std::fabs(chi))) break;
+        }
+        double chi2 = chi * chi;
+        double z = alpha * chi2;
+        stumpff(z, C, S);
+        r = sigma0 * chi * (1.0 - z * S) + (1.0 - alpha * r0) * chi2 * C + r0;
+        if (chi_out) *chi_out = chi;
+
+        // Lagrange coefficients
+        double f = 1.0 - chi2 / r0 * C;
+        double g = dt - chi2 * chi / sqrt_mu * S;
+        double fdot = sqrt_mu / (r * r0) * (z * chi * S - chi);
+        double gdot = 1.0 - chi2 / r * C;
+
+        return {f * y0[0] + g * y0[2], f * y0[1] + g * y0[3], fdot * y0[0] + gdot * y0[2],
+                fdot * y0[1] + gdot * y0[3]};
+    }
+
+    State<4> y0;
+    double GM, t0;
+    double sqrt_mu, r0, alpha, sigma0, period;
+};
+
+// Two-body state dt seconds after y0
+inline State<4> keplerPropagate(const State<4> &y0, double GM, double dt) {
+    return KeplerOrbit(y0, GM).state(dt);
+}
+
+#endif // KEPLER_HPP
@@ -0,0 +1,226 @@
+#ifndef MAPPED_TRAJECTORY_HPP
+#define MAPPED_TRAJECTORY_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ode.hpp"
+#include "trajectory.hpp"
+#include "decimation.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* Random access to output files without reading them.
+ *
+ * MappedFile maps a whole file read-only; pages are only brought in when
+ * touched. MappedTrajectory puts a .traj file (trajectory.hpp) on top:
+ * the last row is a direct load from the end of each column in the last
+ * block, and a time lookup is a binary search on the mapped time column,
+ * touching O(log rows) of its pages plus one page per column for the
+ * values. lastLine() finds the last record of the text .dat files by
+ * scanning back from the end of the mapping.
+ */
+
+class MappedFile {
+public:
+    MappedFile() {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &path) {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            std::cerr << "Error opening file: " << path << std::endl;
+            return false;
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(file, &size);
+        size_ = static_cast<std::size_t>(size.QuadPart);
+        if (size_ > 0) {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping) {
+                data_ = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Error opening file: " << path << std::endl;
+            return false;
+        }
+        struct stat st;
+        size_ = fstat(fd, &st) == 0 ? static_cast<std::size_t>(st.st_size) : 0;
+        if (size_ > 0) {
+            void *p = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+            data_ = p == MAP_FAILED ? nullptr : static_cast<const char *>(p);
+        }
+        ::close(fd);
+#endif
+        if (size_ > 0 && !data_) {
+            std::cerr << "Error mapping file: " << path << std::endl;
+            size_ = 0;
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (data_) {
+#ifdef _WIN32
+            UnmapViewOfFile(data_);
+#else
+            munmap(const_cast<char *>(data_), size_);
+#endif
+        }
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const char *data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// Last non-empty line of a mapped text file, without its newline
+inline std::string lastLine(const MappedFile &file) {
+    const char *begin = file.data(), *end = begin + file.size();
+    while (end > begin && (end[-1] == '\n' || end[-1] == '\r')) --end;
+    const char *start = end;
+    while (start > begin && start[-1] != '\n') --start;
+    return std::string(start, end);
+}
+
+class MappedTrajectory {
+public:
+    bool open(const std::string &path) {
+        names.clear();
+        nrow = 0;
+        if (!file.open(path)) return false;
+
+        const char *p = file.data();
+        traj::Header h;
+        if (file.size() < traj::header_size) {
+            std::cerr << "Not a trajectory file: " << path << std::endl;
+            file.close();
+            return false;
+        }
+        if (!traj::parseHeader(p, h, path)) {
+            file.close();
+            return false;
+        }
+        // Divisions rather than products, which a corrupt header could
+        // make overflow
+        if (h.ncol == 0 || h.offset > file.size() || h.offset < traj::header_size ||
+            (h.offset - traj::header_size) / traj::name_size < h.ncol ||
+            (file.size() - h.offset) / sizeof(double) / h.ncol < h.rows) {
+            std::cerr << "Truncated or corrupt trajectory file: " << path << std::endl;
+            file.close();
+            return false;
+        }
+        for (std::uint32_t c = 0; c < h.ncol; ++c) {
+            char field[traj::name_size + 1] = {};
+            std::memcpy(field, p + traj::header_size + c * traj::name_size, traj::name_size);
+            names.push_back(field);
+        }
+        base = reinterpret_cast<const double *>(p + h.offset);
+        nrow = h.rows;
+        block = h.block;
+        return true;
+    }
+
+    std::size_t rows() const { return nrow; }
+    std::size_t columns() const { return names.size(); }
+    const std::vector<std::string> &columnNames() const { return names; }
+
+    // Value of column c in row r
+    double value(std::size_t c, std::size_t r) const {
+        // Row r is in the block starting at row first, of n rows
+        std::size_t first = r - r % block, n = std::min(block, nrow - first);
+        return base[first * names.size() + c * n + (r - first)];
+    }
+
+    // Index of the column called name, columns() if there is none
+    std::size_t columnIndex(const std::string &name) const {
+        return std::find(names.begin(), names.end(), name) - names.begin();
+    }
+
+    double time(std::size_t r) const { return value(0, r); }
+
+    // Row r: t in row[0], then the other columns
+    void row(std::size_t r, double *values) const {
+        for (std::size_t c = 0; c < names.size(); ++c) values[c] = value(c, r);
+    }
+
+    // State part (columns 1 .. N) of row r
+    template <std::size_t N>
+    void row(std::size_t r, State<N> &y) const {
+        for (std::size_t i = 0; i < N && i + 1 < names.size(); ++i) y[i] = value(i + 1, r);
+    }
+
+    // First row with time >= t (rows() if none). A binary search on the
+    // mapped t column: touches O(log rows) pages and nothing else.
+    std::size_t lowerBound(double t) const {
+        std::size_t lo = 0, hi = nrow;
+        while (lo < hi) {
+            std::size_t mid = lo + (hi - lo) / 2;
+            if (time(mid) < t) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    // Rows with t_begin <= t <= t_end, as [first, last)
+    std::pair<std::size_t, std::size_t> range(double t_begin, double t_end) const {
+        std::size_t first = lowerBound(t_begin), last = lowerBound(t_end);
+        while (last < nrow && time(last) <= t_end) ++last;
+        return {first, last};
+    }
+
+    // State at t, Hermite-interpolated between the neighbouring rows for
+    // states laid out as positions then velocities (every orbit and
+    // decimated file). False if t is outside the file.
+    template <std::size_t N>
+    bool state(double t, State<N> &y) const {
+        if (nrow == 0 || !(t >= time(0) && t <= time(nrow - 1))) return false;
+        std::size_t r = lowerBound(t);
+        row(r, y);
+        if (time(r) == t) return true;
+        State<N> y0;
+        row(r - 1, y0);
+        hermitePositionVelocity(time(r - 1), y0, time(r), State<N>(y), t, y);
+        return true;
+    }
+
+private:
+    MappedFile file;
+    std::vector<std::string> names;
+    const double *base = nullptr;
+    std::size_t nrow = 0;
+    std::size_t block = 1; // Rows per block
+};
+
+#endif // MAPPED_TRAJECTORY_HPP
@@ -0,0 +1,159 @@
+#ifndef MULTISTEP_HPP
+#define MULTISTEP_HPP
+
+#include <array>
+#include "ode.hpp"
+
+/* Adams-Bashforth-Moulton predictor-corrector of order 1 to 8.
+ * Past derivatives live in a fixed ring buffer, so after the RK4 start-up
+ * steps no history is copied or reallocated: each new derivative just
+ * overwrites the oldest slot.
+ */
+
+const int abm_max_order = 8;
+
+/* Predictor (Adams-Bashforth) and corrector (Adams-Moulton) weights for
+ * each order k, scaled by a common denominator. AB weights apply to
+ * f_n, f_n-1, ..., f_n-k+1; AM weights to f_n+1, f_n, ..., f_n-k+2.
+ */
+namespace abm {
+const double denom[abm_max_order + 1] = {0, 1, 2, 12, 24, 720, 1440, 60480, 120960};
+const double ab[abm_max_order + 1][abm_max_order] = {
+    {},
+    {1},
+    {3, -1},
+    {23, -16, 5},
+    {55, -59, 37, -9},
+    {1901, -2774, 2616, -1274, 251},
+    {4277, -7923, 9982, -7298, 2877, -475},
+    {198721, -447288, 705549, -688256, 407139, -134472, 19087},
+    {434241, -1152169, 2183877, -2664477, 2102243, -1041723, 295767, -36799},
+};
+const double am[abm_max_order + 1][abm_max_order] = {
+    {},
+    {1},
+    {1, 1},
+    {5, 8, -1},
+    {9, 19, -5, 1},
+    {251, 646, -264, 106, -19},
+    {475, 1427, -798, 482, -173, 27},
+    {19087, 65112, -46461, 37504, -20211, 6312, -863},
+    {36799, 139849, -121797, 123133, -88547, 41499, -11351, 1375},
+};
+} // namespace abm
+
+/* Derivative history f_n, f_n-1, ... in a ring buffer */
+template <std::size_t N>
+struct DerivativeHistory {
+    std::array<State<N>, abm_max_order> f;
+    int head = 0;  // Slot of the newest derivative f_n
+    int count = 0; // Number of valid entries
+
+    void push(const State<N> &fn) {
+        head = (head + 1) % abm_max_order;
+        f[head] = fn;
+        if (count < abm_max_order) ++count;
+    }
+
+    // f_n-j
+    const State<N> &back(int j) const { return f[(head - j + abm_max_order) % abm_max_order]; }
+};
+
+/* Core loop of adamsBashforthMoulton: advances y, the step count n (t =
+ * t0 + n * h) and the derivative history in place towards tf, so a run
+ * can be stopped and continued (see checkpoint.hpp). With an empty history
+ * it starts from scratch. Returns the number of rhs calls made.
+ */
+template <std::size_t N, typename Rhs, typename Output>
+long adamsBashforthMoultonAdvance(Rhs rhs, double t0, long &n, State<N> &y, DerivativeHistory<N> &hist, double h,
+                                  double tf, int order, bool final_eval, Output &out) {
+    if (order < 1) order = 1;
+    if (order > abm_max_order) order = abm_max_order;
+
+    double t = t0 + n * h;
+    State<N> fn, k2, k3, k4, ytmp, ypred, fpred;
+    long evals = 0;
+
+    if (hist.count == 0) {
+        rhs(t, y, fn);
+        evals++;
+        hist.push(fn);
+    }
+
+    // Start-up: RK4 until the history holds order derivatives
+    while (t < tf && hist.count < order) {
+        const State<N> &k1 = hist.back(0);
+        for (std::size_t i = 0; i < N; ++i) ytmp[i] = y[i] + 0.5 * h * k1[i];
+        rhs(t + h / 2.0, ytmp, k2);
+        for (std::size_t i = 0; i < N; ++i) ytmp[i] = y[i] + 0.5 * h * k2[i];
+        rhs(t + h / 2.0, ytmp, k3);
+        for (std::size_t i = 0; i < N; ++i) ytmp[i] = y[i] + h * k3[i];
+        rhs(t + h, ytmp, k4);
+        for (std::size_t i = 0; i < N; ++i) {
+            y[i] += h * (k1[i] + 2.0 * k2[i] + 2.0 * k3[i] + k4[i]) / 6.0;
+        }
+        t = t0 + (++n) * h;
+        rhs(t, y, fn);
+        evals += 4;
+        hist.push(fn);
+        out(t, y);
+    }
+
+    const double *ab = abm::ab[order];
+    const double *am = abm::am[order];
+    const double scale = h / abm::denom[order];
+
+    while (t < tf) {
+        // Predict
+        for (std::size_t i = 0; i < N; ++i) {
+            double sum = 0.0;
+            for (int j = 0; j < order; ++j) sum += ab[j] * hist.back(j)[i];
+            ypred[i] = y[i] + scale * sum;
+        }
+        double tnew = t0 + (n + 1) * h;
+        rhs(tnew, ypred, fpred);
+        evals++;
+
+        // Correct
+        for (std::size_t i = 0; i < N; ++i) {
+            double sum = am[0] * fpred[i];
+            for (int j = 1; j < order; ++j) sum += am[j] * hist.back(j - 1)[i];
+            y[i] += scale * sum;
+        }
+        t = tnew;
+        ++n;
+
+        // Evaluate
+        if (final_eval) {
+            rhs(t, y, fn);
+            evals++;
+            hist.push(fn);
+        } else {
+            hist.push(fpred);
+        }
+        out(t, y);
+    }
+
+    return evals;
+}
+
+// Adams-Bashforth-Moulton method (PECE)
+// order: 1..8. The first order - 1 steps are taken with RK4. After that
+// each step costs two rhs calls: one for the predicted state and one for
+// the corrected state, which also goes into the history. With
+// final_eval = false (PEC) the second call is skipped and the predicted
+// derivative is kept instead: one rhs call per step, slightly less
+// accurate and less stable. out(t, y) is called after every step.
+template <std::size_t N, typename Rhs, typename Output = NoOutput>
+State<N> adamsBashforthMoulton(Rhs rhs, double t0, const State<N> &y0, double h, double tf, int order = 4,
+                               bool final_eval = true, Output out = Output(), long *rhs_evals = nullptr) {
+    State<N> y = y0;
+    DerivativeHistory<N> hist;
+    long n = 0;
+    long evals = adamsBashforthMoultonAdvance(rhs, t0, n, y, hist, h, tf, order, final_eval, out);
+
+    if (rhs_evals) *rhs_evals = evals;
+    return y;
+}
+
+#endif // MULTISTEP_HPP
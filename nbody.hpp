@@ -0,0 +1,371 @@
+#ifndef NBODY_HPP
+#define NBODY_HPP
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include "orbit.hpp"
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/* General planar N-body gravity: every body pulls on every other one.
+ * Bodies are stored as structure of arrays like the Ensemble, with the
+ * gravitational parameter G * m kept instead of the mass.
+ *
+ * Two force paths:
+ *  - direct sum, O(N^2), vectorized over the source bodies (AVX2/AVX-512
+ *    like ensemble.hpp, scalar otherwise); exact, best for small N.
+ *  - Barnes-Hut, O(N log N): a quadtree of bucketed leaves, rebuilt at
+ *    every evaluation; a cell whose size / distance is below theta acts as
+ *    a point mass at its centre of mass.
+ *
+ * Build with -O3 -march=native to enable the vector kernels.
+ */
+struct NBody {
+    std::vector<double> gm, x, y, vx, vy;
+
+    NBody() {}
+    explicit NBody(std::size_t n) : gm(n), x(n), y(n), vx(n), vy(n) {}
+
+    std::size_t size() const { return x.size(); }
+
+    void set(std::size_t i, double mass, const OrbitState &s) {
+        gm[i] = G * mass;
+        x[i] = s[0];
+        y[i] = s[1];
+        vx[i] = s[2];
+        vy[i] = s[3];
+    }
+
+    void add(double mass, const OrbitState &s) {
+        gm.push_back(G * mass);
+        x.push_back(s[0]);
+        y.push_back(s[1]);
+        vx.push_back(s[2]);
+        vy.push_back(s[3]);
+    }
+
+    OrbitState get(std::size_t i) const { return {x[i], y[i], vx[i], vy[i]}; }
+};
+
+enum class NBodyMethod { Direct, BarnesHut, Auto };
+
+struct NBodyOptions {
+    NBodyMethod method = NBodyMethod::Auto;
+    double theta = 0.5;             // Barnes-Hut opening angle
+    double softening = 0.0;         // Plummer softening length [m]
+    std::size_t auto_cutoff = 3000; // Auto: direct sum below this many bodies (crossover in bench_nbody)
+};
+
+/* Direct sum: ax, ay of bodies [begin, end) from all n sources at (x, y).
+ * The self term has zero separation and is masked out, so softening may
+ * be zero.
+ */
+inline void nbodyAccelDirect(const double *gm, const double *x, const double *y, std::size_t n, double eps2,
+                             double *ax, double *ay, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+        const double xi = x[i], yi = y[i];
+        double sx = 0.0, sy = 0.0;
+        std::size_t j = 0;
+
+#if defined(__AVX512F__)
+        const __m512d vxi = _mm512_set1_pd(xi), vyi = _mm512_set1_pd(yi), veps = _mm512_set1_pd(eps2);
+        const __m512d vhalf = _mm512_set1_pd(0.5), vthreehalf = _mm512_set1_pd(1.5);
+        __m512d accx = _mm512_setzero_pd(), accy = _mm512_setzero_pd();
+        for (; j + 8 <= n; j += 8) {
+            __m512d dx = _mm512_sub_pd(_mm512_loadu_pd(x + j), vxi);
+            __m512d dy = _mm512_sub_pd(_mm512_loadu_pd(y + j), vyi);
+            __m512d d2 = _mm512_fmadd_pd(dx, dx, _mm512_mul_pd(dy, dy));
+            __mmask8 live = _mm512_cmp_pd_mask(d2, _mm512_setzero_pd(), _CMP_GT_OQ);
+            __m512d r2 = _mm512_add_pd(d2, veps);
+            // 1 / r from the 14-bit estimate and two Newton steps, which
+            // is much cheaper than sqrt and div. The zero-masked form, as
+            // GCC's _mm512_rsqrt14_pd passes an undefined operand and warns
+            // with -Wmaybe-uninitialized
+            __m512d q = _mm512_maskz_rsqrt14_pd(0xFF, r2);
+            __m512d hr2 = _mm512_mul_pd(vhalf, r2);
+            q = _mm512_mul_pd(q, _mm512_fnmadd_pd(hr2, _mm512_mul_pd(q, q), vthreehalf));
+            q = _mm512_mul_pd(q, _mm512_fnmadd_pd(hr2, _mm512_mul_pd(q, q), vthreehalf));
+            __m512d q3 = _mm512_mul_pd(q, _mm512_mul_pd(q, q));
+            __m512d s = _mm512_maskz_mul_pd(live, _mm512_loadu_pd(gm + j), q3);
+            accx = _mm512_fmadd_pd(s, dx, accx);
+            accy = _mm512_fmadd_pd(s, dy, accy);
+        }
+        // Summed by hand for the same reason as rsqrt14 above, in the
+        // order _mm512_reduce_add_pd uses
+        alignas(64) double bx[8], by[8];
+        _mm512_store_pd(bx, accx);
+        _mm512_store_pd(by, accy);
+        sx = ((bx[0] + bx[4]) + (bx[2] + bx[6])) + ((bx[1] + bx[5]) + (bx[3] + bx[7]));
+        sy = ((by[0] + by[4]) + (by[2] + by[6])) + ((by[1] + by[5]) + (by[3] + by[7]));
+#elif defined(__AVX2__)
+        const __m256d vxi = _mm256_set1_pd(xi), vyi = _mm256_set1_pd(yi), veps = _mm256_set1_pd(eps2);
+        const __m256d zero = _mm256_setzero_pd();
+        __m256d accx = zero, accy = zero;
+        for (; j + 4 <= n; j += 4) {
+            __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + j), vxi);
+            __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + j), vyi);
+            __m256d d2 = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+            __m256d live = _mm256_cmp_pd(d2, zero, _CMP_GT_OQ);
+            __m256d r2 = _mm256_add_pd(d2, veps);
+            __m256d s = _mm256_div_pd(_mm256_loadu_pd(gm + j), _mm256_mul_pd(r2, _mm256_sqrt_pd(r2)));
+            s = _mm256_and_pd(s, live);
+            accx = _mm256_add_pd(accx, _mm256_mul_pd(s, dx));
+            accy = _mm256_add_pd(accy, _mm256_mul_pd(s, dy));
+        }
+        alignas(32) double bx[4], by[4];
+        _mm256_store_pd(bx, accx);
+        _mm256_store_pd(by, accy);
+        sx = (bx[0] + bx[1]) + (bx[2] + bx[3]);
+        sy = (by[0] + by[1]) + (by[2] + by[3]);
+#endif
+
+        // Scalar tail (or all sources without SIMD)
+        for (; j < n; ++j) {
+            double dx = x[j] - xi, dy = y[j] - yi;
+            double d2 = dx * dx + dy * dy;
+            if (d2 == 0.0) continue;
+            double r2 = d2 + eps2;
+            double s = gm[j] / (r2 * std::sqrt(r2));
+            sx += s * dx;
+            sy += s * dy;
+        }
+        ax[i] = sx;
+        ay[i] = sy;
+    }
+}
+
+/* Barnes-Hut quadtree. Nodes live in one vector; a leaf keeps up to
+ * leaf_size bodies in a linked list through next[], an internal node four
+ * children. Leaves at max_depth never split, so coincident bodies are safe.
+ */
+class QuadTree {
+public:
+    static const int leaf_size = 8;
+    static const int max_depth = 48;
+
+    // Build over bodies (gm, x, y)
+    void build(const double *gm, const double *x, const double *y, std::size_t n) {
+        this->gm = gm;
+        this->x = x;
+        this->y = y;
+        nodes.clear();
+        bodies.clear();
+        next.assign(n, -1);
+        if (n == 0) return;
+
+        double xmin = x[0], xmax = x[0], ymin = y[0], ymax = y[0];
+        for (std::size_t i = 1; i < n; ++i) {
+            xmin = std::min(xmin, x[i]);
+            xmax = std::max(xmax, x[i]);
+            ymin = std::min(ymin, y[i]);
+            ymax = std::max(ymax, y[i]);
+        }
+        double half = 0.5 * std::max(xmax - xmin, ymax - ymin) * (1.0 + 1e-12) + 1e-300;
+        nodes.push_back(Node(0.5 * (xmin + xmax), 0.5 * (ymin + ymax), half));
+        for (std::size_t i = 0; i < n; ++i) insert(0, static_cast<int>(i), 0);
+        summarize(0);
+    }
+
+    // Acceleration on body i, opening cells with size / distance >= theta
+    void accel(std::size_t i, double theta, double eps2, double &ax, double &ay) const {
+        const double xi = x[i], yi = y[i];
+        const double theta2 = theta * theta;
+        double sx = 0.0, sy = 0.0;
+
+        int stack[4 * max_depth + 4];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node &nd = nodes[stack[--top]];
+            if (nd.count > 0) { // Leaf: sum its bodies directly
+                for (int j = nd.first; j >= 0; j = next[j]) {
+                    double dx = x[j] - xi, dy = y[j] - yi;
+                    double d2 = dx * dx + dy * dy;
+                    if (d2 == 0.0) continue;
+                    double r2 = d2 + eps2;
+                    double s = gm[j] / (r2 * std::sqrt(r2));
+                    sx += s * dx;
+                    sy += s * dy;
+                }
+                continue;
+            }
+            if (nd.child[0] < 0) continue; // Empty
+
+            double dx = nd.comx - xi, dy = nd.comy - yi;
+            double d2 = dx * dx + dy * dy;
+            double size = 2.0 * nd.half;
+            if (size * size < theta2 * d2) { // Far enough: one point mass
+                double r2 = d2 + eps2;
+                double s = nd.gm / (r2 * std::sqrt(r2));
+                sx += s * dx;
+                sy += s * dy;
+            } else {
+                for (int c = 0; c < 4; ++c) stack[top++] = nd.child[c];
+            }
+        }
+        ax = sx;
+        ay = sy;
+    }
+
+    std::size_t size() const { return nodes.size(); }
+
+    // Bodies leaf by leaf in depth-first order: neighbours in space are
+    // neighbours here, so consecutive walks touch the same nodes
+    const std::vector<int> &order() const { return bodies; }
+
+private:
+    struct Node {
+        double cx, cy, half;           // Square cell
+        double gm = 0.0;               // Total G * m
+        double comx = 0.0, comy = 0.0; // Centre of mass
+        int child[4] = {-1, -1, -1, -1};
+        int first = -1; // Leaf: first body
+        int count = 0;  // Leaf: number of bodies (0 for internal or empty)
+
+        Node(double cx, double cy, double half) : cx(cx), cy(cy), half(half) {}
+    };
+
+    int quadrant(const Node &nd, int b) const { return (x[b] >= nd.cx ? 1 : 0) + (y[b] >= nd.cy ? 2 : 0); }
+
+    void insert(int k, int b, int depth) {
+        while (nodes[k].child[0] >= 0) { // Descend through internal nodes
+            k = nodes[k].child[quadrant(nodes[k], b)];
+            ++depth;
+        }
+        if (nodes[k].count < leaf_size || depth >= max_depth) {
+            next[b] = nodes[k].first;
+            nodes[k].first = b;
+            nodes[k].count++;
+            return;
+        }
+
+        // Split the full leaf, then hand its bodies and b to the children
+        double h = 0.5 * nodes[k].half;
+        for (int c = 0; c < 4; ++c) {
+            double cx = nodes[k].cx + ((c & 1) ? h : -h);
+            double cy = nodes[k].cy + ((c & 2) ? h : -h);
+            nodes[k].child[c] = static_cast<int>(nodes.size());
+            nodes.push_back(Node(cx, cy, h));
+        }
+        int j = nodes[k].first;
+        nodes[k].first = -1;
+        nodes[k].count = 0;
+        while (j >= 0) {
+            int jn = next[j];
+            insert(k, j, depth);
+            j = jn;
+        }
+        insert(k, b, depth);
+    }
+
+    // Total mass and centre of mass of every node, bottom-up
+    void summarize(int k) {
+        double m = 0.0, mx = 0.0, my = 0.0;
+        if (nodes[k].child[0] >= 0) {
+            for (int c = 0; c < 4; ++c) {
+                int ch = nodes[k].child[c];
+                summarize(ch);
+                m += nodes[ch].gm;
+                mx += nodes[ch].gm * nodes[ch].comx;
+                my += nodes[ch].gm * nodes[ch].comy;
+            }
+        } else {
+            for (int j = nodes[k].first; j >= 0; j = next[j]) {
+                bodies.push_back(j);
+                m += gm[j];
+                mx += gm[j] * x[j];
+                my += gm[j] * y[j];
+            }
+        }
+        Node &nd = nodes[k];
+        nd.gm = m;
+        nd.comx = m > 0.0 ? mx / m : nd.cx;
+        nd.comy = m > 0.0 ? my / m : nd.cy;
+    }
+
+    std::vector<Node> nodes;
+    std::vector<int> next;
+    std::vector<int> bodies;
+    const double *gm = nullptr, *x = nullptr, *y = nullptr;
+};
+
+/* Accelerations of all bodies at positions (x, y) with the chosen method.
+ * Keeps the quadtree between calls so its storage is reused.
+ */
+class NBodyForces {
+public:
+    explicit NBodyForces(const NBodyOptions &opt = NBodyOptions()) : opt(opt) {}
+
+    bool usesTree(std::size_t n) const {
+        return opt.method == NBodyMethod::BarnesHut || (opt.method == NBodyMethod::Auto && n >= opt.auto_cutoff);
+    }
+
+    void operator()(const double *gm, const double *x, const double *y, std::size_t n, double *ax, double *ay) {
+        double eps2 = opt.softening * opt.softening;
+        if (!usesTree(n)) {
+            nbodyAccelDirect(gm, x, y, n, eps2, ax, ay, 0, n);
+            return;
+        }
+        tree.build(gm, x, y, n);
+        for (int i : tree.order()) tree.accel(i, opt.theta, eps2, ax[i], ay[i]);
+    }
+
+private:
+    NBodyOptions opt;
+    QuadTree tree;
+};
+
+// Runge-Kutta 4th order method for the whole system
+// Same stage arithmetic as rungeKutta4; the system is updated in place and
+// out(t, sys) is called after every step.
+template <typename Output = NoOutput>
+void rungeKutta4NBody(NBody &sys, double t0, double h, double tf, const NBodyOptions &opt = NBodyOptions(),
+                      Output out = Output()) {
+    const std::size_t n = sys.size();
+    NBodyForces forces(opt);
+
+    // Stage slopes (velocity, acceleration) and stage positions
+    std::vector<double> kx[4], ky[4], kvx[4], kvy[4];
+    for (int s = 0; s < 4; ++s) {
+        kx[s].resize(n);
+        ky[s].resize(n);
+        kvx[s].resize(n);
+        kvy[s].resize(n);
+    }
+    std::vector<double> tx(n), ty(n);
+
+    double t = t0;
+    long step = 0;
+    while (t < tf) {
+        kx[0] = sys.vx;
+        ky[0] = sys.vy;
+        forces(sys.gm.data(), sys.x.data(), sys.y.data(), n, kvx[0].data(), kvy[0].data());
+
+        const double c[3] = {0.5 * h, 0.5 * h, h};
+        for (int s = 0; s < 3; ++s) {
+            for (std::size_t i = 0; i < n; ++i) {
+                tx[i] = sys.x[i] + c[s] * kx[s][i];
+                ty[i] = sys.y[i] + c[s] * ky[s][i];
+                kx[s + 1][i] = sys.vx[i] + c[s] * kvx[s][i];
+                ky[s + 1][i] = sys.vy[i] + c[s] * kvy[s][i];
+            }
+            forces(sys.gm.data(), tx.data(), ty.data(), n, kvx[s + 1].data(), kvy[s + 1].data());
+        }
+
+        for (std::size_t i = 0; i < n; ++i) {
+            sys.x[i] += h * (kx[0][i] + 2.0 * kx[1][i] + 2.0 * kx[2][i] + kx[3][i]) / 6.0;
+            sys.y[i] += h * (ky[0][i] + 2.0 * ky[1][i] + 2.0 * ky[2][i] + ky[3][i]) / 6.0;
+            sys.vx[i] += h * (kvx[0][i] + 2.0 * kvx[1][i] + 2.0 * kvx[2][i] + kvx[3][i]) / 6.0;
+            sys.vy[i] += h * (kvy[0][i] + 2.0 * kvy[1][i] + 2.0 * kvy[2][i] + kvy[3][i]) / 6.0;
+        }
+
+        t = t0 + (++step) * h;
+        out(t, sys);
+    }
+}
+
+#endif // NBODY_HPP
@@ -2,6 +2,7 @@
 #include <cmath>
 #include <valarray>
 #include "q3-4.hpp"
+#include "newton.hpp"
 
 using namespace std;
 
@@ -15,20 +16,6 @@ void print_vec(double v[2]) {
     cout << v[0] << ' ' << v[1] << endl;
 }
 
-/* Function to calculate the inverse of a 2x2 matrix */
-void mat_inv_2x2(double J[2][2], double J_inv[2][2]) {
-    double det = J[0][0] * J[1][1] - J[0][1] * J[1][0];
-    if (det == 0) {
-        cerr << "Error: Matrix is singular, cannot invert." << endl;
-        return;
-    }
-
-    J_inv[0][0] = J[1][1] / det;
-    J_inv[0][1] = -J[0][1] / det;
-    J_inv[1][0] = -J[1][0] / det;
-    J_inv[1][1] = J[0][0] / det;
-}
-
 /* Implement the system of equations function f and its Jacobian function f_Jac */
 void f(double result[2], const double x[2]) {
     // Define the equations here based on the problem description
@@ -44,54 +31,46 @@ void f_Jac(double jacobian[2][2], const double x[2]) {
     jacobian[1][1] = 2 * x[1];
 }
 
-/* Implement the 2D Newton-Raphson method for solving a system of equations */
+/* Solve the 2D system with the generic Newton solver (newton.hpp): LU
+ * solves instead of inverting the Jacobian, damped steps, and an error
+ * rather than garbage on a singular Jacobian. Converged when each step
+ * is below TOL relative to 1 + |x|. */
 int newton_raphson(double xi[2], const double x0[2], int Nmax, double TOL) {
-    double x[2], dx[2], fx[2], J[2][2], J_inv[2][2];
-    int i = 0;
-
-    // Initialize x with the initial guess x0
-    x[0] = x0[0];
-    x[1] = x0[1];
-
-    do {
-        // Evaluate the function values and Jacobian at the current point x
-        f(fx, x);
-        f_Jac(J, x);
-
-        // Calculate the inverse of the Jacobian matrix
-        mat_inv_2x2(J, J_inv);
-
-        // Compute the Newton-Raphson update
-        dx[0] = -J_inv[0][0] * fx[0] - J_inv[0][1] * fx[1];
-        dx[1] = -J_inv[1][0] * fx[0] - J_inv[1][1] * fx[1];
-
-        // Update x
-        x[0] += dx[0];
-        x[1] += dx[1];
-
-        // Increment iteration count
-        i++;
-
-        // Check convergence criteria
-    } while ((fabs(dx[0] / x[0]) > TOL || fabs(dx[1] / x[1]) > TOL) && i <= Nmax);
+    State<2> x = {x0[0], x0[1]};
+    NewtonOptions opt;
+    opt.xtol = TOL;
+    opt.max_iter = Nmax;
+    NewtonStats stats;
+
+    NewtonStatus status = newtonSolve(
+        [](State<2> &fx, const State<2> &x) { f(fx.data(), x.data()); },
+        [](Matrix<2> &J, const State<2> &x) {
+            double Jc[2][2];
+            f_Jac(Jc, x.data());
+            J = {{{Jc[0][0], Jc[0][1]}, {Jc[1][0], Jc[1][1]}}};
+        },
+        x, opt, &stats);
 
     // Store the final solution in xi
     xi[0] = x[0];
     xi[1] = x[1];
 
     // Output the iteration count and convergence status
-    if (i > Nmax) {
-        cout << "Newton-Raphson did not converge after " << Nmax << " iterations." << endl;
+    if (status == NewtonStatus::Singular) {
+        cerr << "Error: Jacobian is singular." << endl;
+        return -1;
+    } else if (status != NewtonStatus::Converged) {
+        cout << "Newton-Raphson did not converge after " << stats.iterations << " iterations." << endl;
         return -1;
     } else {
-        cout << "Newton-Raphson converged after " << i << " iterations." << endl;
+        cout << "Newton-Raphson converged after " << stats.iterations << " iterations." << endl;
         return 0;
     }
 }
 
 int main() {
     // Define parameters for Newton-Raphson method
-    double x0[2] = {1.0, 1.0}; // Initial guess
+    double x0[2] = {3.0, 1.0}; // Initial guess (the Jacobian is singular on x = y, e.g. at (1, 1))
     int Nmax = 100;             // Maximum number of iterations
     double TOL = 1e-6;          // Tolerance for convergence
 
@@ -0,0 +1,282 @@
+#ifndef NEWTON_HPP
+#define NEWTON_HPP
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "ode.hpp"
+
+/* Newton's method for F(x) = 0 in N unknowns, generalising newton_raphson
+ * in newton-raphson.cpp. The functions keep its calling convention,
+ * f(fx, x) and f_Jac(J, x) with the result first.
+ *
+ * Small systems use State<N> and Matrix<N>: the size is fixed at compile
+ * time and the solver allocates nothing. Larger ones use
+ * std::vector<double> and a vector of rows, sized by x; their workspace is
+ * allocated once per solve, not per iteration. Each step solves
+ * J dx = -F with an LU factorization with partial pivoting; the inverse
+ * is never formed.
+ *
+ * The Jacobian is usually the expensive part, so it need not be
+ * re-evaluated every iteration:
+ *   Newton   evaluate and factor J every iteration;
+ *   Chord    keep the factored J and re-evaluate it only when the
+ *            residual stops falling fast (by less than chord_ratio);
+ *   Broyden  keep the factored J and apply Broyden's good update of the
+ *            inverse as rank-one terms on top of the LU solve
+ *            (J_k^-1 = (I + u_k s_k^T) ... (I + u_0 s_0^T) J_0^-1), so an
+ *            iteration is O(n^2) with no refactorization; J is
+ *            re-evaluated only when a step fails or after max_updates
+ *            updates.
+ * Steps are damped by backtracking: while ||F|| does not decrease enough
+ * (Armijo condition on ||F||^2) the step is halved. A step that finds no
+ * decrease even with a fresh Jacobian is not taken: the solve stops with
+ * NewtonStatus::LineSearchFailed and x at the last accepted iterate.
+ */
+
+enum class NewtonMode { Newton, Chord, Broyden };
+
+enum class NewtonStatus {
+    Converged,
+    MaxIterations,   // max_iter iterations without converging
+    Singular,        // A Jacobian had no LU factorization
+    LineSearchFailed // No decrease in ||F|| along the Newton direction
+};
+
+struct NewtonOptions {
+    NewtonMode mode = NewtonMode::Newton;
+    double xtol = 1e-10;     // Converged when every |dx_i| <= xtol * (1 + |x_i|)
+    double ftol = 0.0;       // or when ||F|| <= ftol
+    int max_iter = 100;
+    int max_halvings = 20;   // Line search halvings per step (0: undamped)
+    double chord_ratio = 0.5; // Chord: refresh J when ||F|| falls by less than this
+};
+
+/* Work counters filled in by newtonSolve */
+struct NewtonStats {
+    int iterations = 0;
+    long f_evals = 0;
+    long jac_evals = 0;
+    long factorizations = 0;
+};
+
+namespace newton_detail {
+const std::size_t max_updates = 16; // Broyden updates kept before J is re-evaluated
+
+// Pivots and Broyden updates: fixed-size arrays for State<N>, vectors
+// sized once for std::vector
+template <typename Vec>
+struct Workspace;
+
+template <std::size_t N>
+struct Workspace<State<N>> {
+    std::array<std::size_t, N> piv;
+    std::array<State<N>, max_updates> us, ss;
+
+    Workspace(std::size_t, bool) {}
+};
+
+template <>
+struct Workspace<std::vector<double>> {
+    std::vector<std::size_t> piv;
+    std::vector<std::vector<double>> us, ss;
+
+    Workspace(std::size_t n, bool broyden)
+        : piv(n), us(broyden ? max_updates : 0, std::vector<double>(n)), ss(us) {}
+};
+
+// In-place LU factorization with partial pivoting: a = P L U with unit L
+// below the diagonal. Returns false if a is singular.
+template <typename Mat, typename Piv>
+bool luFactor(Mat &a, Piv &piv, std::size_t n) {
+    for (std::size_t k = 0; k < n; ++k) {
+        std::size_t p = k;
+        for (std::size_t i = k + 1; i < n; ++i) {
+            if (std::fabs(a[i][k]) > std::fabs(a[p][k])) p = i;
+        }
+        piv[k] = p;
+        if (a[p][k] == 0.0) return false;
+        if (p != k) std::swap(a[p], a[k]);
+        for (std::size_t i = k + 1; i < n; ++i) {
+            double l = a[i][k] /= a[k][k];
+            for (std::size_t j = k + 1; j < n; ++j) a[i][j] -= l * a[k][j];
+        }
+    }
+    return true;
+}
+
+// Solve a x = b with the factors from luFactor, overwriting b
+template <typename Mat, typename Piv, typename Vec>
+void luSolve(const Mat &a, const Piv &piv, Vec &b, std::size_t n) {
+    for (std::size_t k = 0; k < n; ++k) {
+        if (piv[k] != k) std::swap(b[k], b[piv[k]]);
+    }
+    for (std::size_t i = 1; i < n; ++i) {
+        for (std::size_t j = 0; j < i; ++j) b[i] -= a[i][j] * b[j];
+    }
+    for (std::size_t i = n; i-- > 0;) {
+        for (std::size_t j = i + 1; j < n; ++j) b[i] -= a[i][j] * b[j];
+        b[i] /= a[i][i];
+    }
+}
+
+template <typename Vec>
+double norm(const Vec &v, std::size_t n) {
+    double s = 0.0;
+    for (std::size_t i = 0; i < n; ++i) s += v[i] * v[i];
+    return std::sqrt(s);
+}
+
+template <typename Vec, typename Mat, typename F, typename Jac>
+NewtonStatus solve(F &f, Jac &jac, Vec &x, Vec fx, Mat J, const NewtonOptions &opt, NewtonStats &st) {
+    const std::size_t n = x.size();
+    const bool broyden = opt.mode == NewtonMode::Broyden;
+    Mat lu = J;
+    Vec dx = x, x_new = x, f_new = fx, hy = x;
+    Workspace<Vec> ws(n, broyden);
+    std::size_t updates = 0; // Broyden updates since the last factorization
+
+    f(fx, x);
+    ++st.f_evals;
+    double fnorm = norm(fx, n);
+    bool fresh = false; // J evaluated at the current x
+
+    auto evaluateJacobian = [&]() {
+        jac(J, x);
+        ++st.jac_evals;
+        fresh = true;
+    };
+    auto factor = [&]() {
+        updates = 0;
+        lu = J;
+        ++st.factorizations;
+        return luFactor(lu, ws.piv, n);
+    };
+    // b = J^-1 b with the Broyden updates applied
+    auto solveJacobian = [&](Vec &b) {
+        luSolve(lu, ws.piv, b, n);
+        for (std::size_t k = 0; k < updates; ++k) {
+            double d = 0.0;
+            for (std::size_t i = 0; i < n; ++i) d += ws.ss[k][i] * b[i];
+            for (std::size_t i = 0; i < n; ++i) b[i] += ws.us[k][i] * d;
+        }
+    };
+    // Every |step_i| <= xtol * (1 + |x_i|)
+    auto small = [&](double lambda, const Vec &at) {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (std::fabs(lambda * dx[i]) > opt.xtol * (1.0 + std::fabs(at[i]))) return false;
+        }
+        return true;
+    };
+
+    if (opt.ftol > 0.0 && fnorm <= opt.ftol) return NewtonStatus::Converged;
+    evaluateJacobian();
+    if (!factor()) return NewtonStatus::Singular;
+
+    while (st.iterations < opt.max_iter) {
+        if (opt.mode == NewtonMode::Newton && !fresh) {
+            evaluateJacobian();
+            if (!factor()) return NewtonStatus::Singular;
+        }
+
+        for (std::size_t i = 0; i < n; ++i) dx[i] = -fx[i];
+        solveJacobian(dx);
+
+        // Backtrack until ||F||^2 drops by the Armijo fraction of the
+        // decrease the linear model predicts
+        double lambda = 1.0, fnorm_new;
+        bool accepted = false;
+        for (int k = 0;; ++k) {
+            for (std::size_t i = 0; i < n; ++i) x_new[i] = x[i] + lambda * dx[i];
+            f(f_new, x_new);
+            ++st.f_evals;
+            fnorm_new = norm(f_new, n);
+            if (fnorm_new * fnorm_new <= (1.0 - 1e-4 * lambda) * fnorm * fnorm) {
+                accepted = true;
+                break;
+            }
+            if (k >= opt.max_halvings) break;
+            lambda *= 0.5;
+        }
+
+        if (!accepted && opt.max_halvings > 0) {
+            // A stale Jacobian may not give a descent direction: evaluate a
+            // fresh one and retry before giving up
+            if (!fresh) {
+                evaluateJacobian();
+                if (!factor()) return NewtonStatus::Singular;
+                continue;
+            }
+            // No decrease along a fresh Newton direction: converged if the
+            // full step is already below xtol (||F|| is at round-off),
+            // stuck otherwise. Either way x stays at the last iterate.
+            return small(1.0, x) ? NewtonStatus::Converged : NewtonStatus::LineSearchFailed;
+        }
+
+        ++st.iterations;
+        bool done = small(lambda, x_new);
+
+        bool restart = false;
+        if (broyden) {
+            if (updates == max_updates) {
+                restart = true;
+            } else {
+                // u = (s - H y) / (s^T H y) with s = x_new - x, y = f_new - fx
+                // and H the current inverse
+                for (std::size_t i = 0; i < n; ++i) hy[i] = f_new[i] - fx[i];
+                solveJacobian(hy);
+                auto &s = ws.ss[updates];
+                auto &u = ws.us[updates];
+                double shy = 0.0;
+                for (std::size_t i = 0; i < n; ++i) {
+                    s[i] = lambda * dx[i];
+                    shy += s[i] * hy[i];
+                }
+                if (shy != 0.0) {
+                    for (std::size_t i = 0; i < n; ++i) u[i] = (s[i] - hy[i]) / shy;
+                    ++updates;
+                }
+            }
+        }
+
+        bool slow = fnorm_new > opt.chord_ratio * fnorm;
+        x = x_new;
+        fx = f_new;
+        fnorm = fnorm_new;
+        fresh = false;
+
+        if (done || (opt.ftol > 0.0 && fnorm <= opt.ftol)) return NewtonStatus::Converged;
+
+        if ((opt.mode == NewtonMode::Chord && slow) || restart) {
+            evaluateJacobian();
+            if (!factor()) return NewtonStatus::Singular;
+        }
+    }
+    return NewtonStatus::MaxIterations;
+}
+} // namespace newton_detail
+
+// Compile-time N: x holds the initial guess and receives the solution
+// (the last iterate if the solve fails).
+template <std::size_t N, typename F, typename Jac>
+NewtonStatus newtonSolve(F f, Jac jac, State<N> &x, const NewtonOptions &opt = NewtonOptions(),
+                         NewtonStats *stats = nullptr) {
+    NewtonStats local;
+    NewtonStats &st = stats ? *stats : local;
+    return newton_detail::solve(f, jac, x, State<N>(), Matrix<N>(), opt, st);
+}
+
+// Runtime N, the size of x; f and f_Jac receive vectors already sized
+template <typename F, typename Jac>
+NewtonStatus newtonSolve(F f, Jac jac, std::vector<double> &x, const NewtonOptions &opt = NewtonOptions(),
+                         NewtonStats *stats = nullptr) {
+    NewtonStats local;
+    NewtonStats &st = stats ? *stats : local;
+    const std::size_t n = x.size();
+    return newton_detail::solve(f, jac, x, std::vector<double>(n),
+                                std::vector<std::vector<double>>(n, std::vector<double>(n)), opt, st);
+}
+
+#endif // NEWTON_HPP
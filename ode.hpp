@@ -0,0 +1,169 @@
+#ifndef ODE_HPP
+#define ODE_HPP
+
+#include <array>
+#include <cstddef>
+
+/* Fixed-size ODE state. The size is known at compile time so every
+ * temporary used by the steppers lives on the stack: no heap allocation
+ * happens inside the step loop.
+ */
+template <std::size_t N>
+using State = std::array<double, N>;
+
+/* State over another scalar type: float for cheap screening runs,
+ * DoubleDouble (precision.hpp) for reference runs. euler and rungeKutta4
+ * and the models in orbit.hpp take any of them; the rest of the steppers
+ * are double only.
+ */
+template <typename T, std::size_t N>
+using BasicState = std::array<T, N>;
+
+// Small dense N x N matrix, row-major: m[row][col]
+template <std::size_t N>
+using Matrix = std::array<std::array<double, N>, N>;
+
+// T in a parameter that must not take part in deduction, so the times of
+// a float or DoubleDouble run can be given as plain double literals
+template <typename T>
+struct NonDeducedT {
+    typedef T type;
+};
+template <typename T>
+using NonDeduced = typename NonDeducedT<T>::type;
+
+/* In-place RHS contract: rhs(t, y, dydt) fills dydt with f(t, y) without
+ * allocating. The steppers take the rhs as a template parameter, so it can
+ * be a plain function or a model functor (see orbit.hpp); a functor's call
+ * is inlined into the step loop and its constants are folded.
+ */
+template <std::size_t N>
+using RhsFunction = void (*)(double t, const State<N> &y, State<N> &dydt);
+
+/* Default observer that discards every state (any time and state type) */
+struct NoOutput {
+    template <typename Time, typename S>
+    void operator()(const Time &, const S &) const {}
+};
+
+/* Cubic Hermite interpolation between (t0, y0, f0) and (t1, y1, f1),
+ * where f is dy/dt. Fourth-order accurate inside an RK4 step.
+ */
+template <std::size_t N>
+void hermiteInterpolate(double t0, const State<N> &y0, const State<N> &f0, double t1, const State<N> &y1,
+                        const State<N> &f1, double t, State<N> &y) {
+    double h = t1 - t0;
+    double s = (t - t0) / h;
+    double s2 = s * s, s3 = s2 * s;
+    double h00 = 2.0 * s3 - 3.0 * s2 + 1.0;
+    double h10 = s3 - 2.0 * s2 + s;
+    double h01 = -2.0 * s3 + 3.0 * s2;
+    double h11 = s3 - s2;
+    for (std::size_t i = 0; i < N; ++i) {
+        y[i] = h00 * y0[i] + h10 * h * f0[i] + h01 * y1[i] + h11 * h * f1[i];
+    }
+}
+
+// Euler's method
+// The observer is called as out(t, y) after every step. The scalar type
+// is that of y0 (double, float or DoubleDouble), and t runs in it too.
+template <typename T, std::size_t N, typename Rhs, typename Output = NoOutput>
+BasicState<T, N> euler(Rhs rhs, NonDeduced<T> t0, const BasicState<T, N> &y0, NonDeduced<T> h,
+                       NonDeduced<T> tf, Output out = Output()) {
+    T t = t0;
+    BasicState<T, N> y = y0;
+    BasicState<T, N> dydt;
+
+    // Evolution loop for Euler's method
+    while (t < tf) {
+        rhs(t, y, dydt);
+        for (std::size_t i = 0; i < N; ++i) {
+            y[i] += h * dydt[i];
+        }
+        t += h;
+        out(t, y);
+    }
+
+    return y;
+}
+
+// Runge-Kutta 4th order method
+// The observer is called as out(t, y) after every step. The scalar type
+// is that of y0, as for euler.
+template <typename T, std::size_t N, typename Rhs, typename Output = NoOutput>
+BasicState<T, N> rungeKutta4(Rhs rhs, NonDeduced<T> t0, const BasicState<T, N> &y0, NonDeduced<T> h,
+                             NonDeduced<T> tf, Output out = Output()) {
+    const T half = T(0.5), two = T(2.0), six = T(6.0);
+    T t = t0;
+    BasicState<T, N> y = y0;
+    BasicState<T, N> k1, k2, k3, k4, ytmp;
+
+    // Evolution loop for 4th order Runge-Kutta
+    while (t < tf) {
+        rhs(t, y, k1);
+        for (std::size_t i = 0; i < N; ++i) ytmp[i] = y[i] + half * h * k1[i];
+        rhs(t + h / two, ytmp, k2);
+        for (std::size_t i = 0; i < N; ++i) ytmp[i] = y[i] + half * h * k2[i];
+        rhs(t + h / two, ytmp, k3);
+        for (std::size_t i = 0; i < N; ++i) ytmp[i] = y[i] + h * k3[i];
+        rhs(t + h, ytmp, k4);
+
+        // Update y using the weighted average of slopes
+        for (std::size_t i = 0; i < N; ++i) {
+            y[i] += h * (k1[i] + two * k2[i] + two * k3[i] + k4[i]) / six;
+        }
+
+        // Move to the next step
+        t += h;
+
+        out(t, y);
+    }
+
+    return y;
+}
+
+// Runge-Kutta 4th order method reporting whole steps
+// step(t0, y0, f0, t1, y1, f1) is called after every step with the
+// derivatives at both ends, which is what interpolation needs. f1 is kept
+// as the next step's k1, so this costs one extra rhs call in total.
+// Returning true from the handler stops the integration; it may move
+// (t1, y1) back to the point where it stopped. Step times are computed as
+// t0 + n * h so they do not drift. t_end receives the final time.
+// To resume a run, pass the state after n0 steps as y0 with the original
+// t0: the grid, and so every result, is the same as without the restart.
+template <std::size_t N, typename Rhs, typename StepHandler>
+State<N> rungeKutta4Steps(Rhs rhs, double t0, const State<N> &y0, double h, double tf,
+                          StepHandler &&step, double *t_end = nullptr, long n0 = 0) {
+    double t = t0 + n0 * h;
+    State<N> y = y0;
+    State<N> k1, k2, k3, k4, ytmp, ynew, fnew;
+
+    rhs(t, y, k1);
+
+    for (long n = n0 + 1; t < tf; ++n) {
+        for (std::size_t i = 0; i < N; ++i) ytmp[i] = y[i] + 0.5 * h * k1[i];
+        rhs(t + h / 2.0, ytmp, k2);
+        for (std::size_t i = 0; i < N; ++i) ytmp[i] = y[i] + 0.5 * h * k2[i];
+        rhs(t + h / 2.0, ytmp, k3);
+        for (std::size_t i = 0; i < N; ++i) ytmp[i] = y[i] + h * k3[i];
+        rhs(t + h, ytmp, k4);
+
+        // Update y using the weighted average of slopes
+        for (std::size_t i = 0; i < N; ++i) {
+            ynew[i] = y[i] + h * (k1[i] + 2.0 * k2[i] + 2.0 * k3[i] + k4[i]) / 6.0;
+        }
+        double tnew = t0 + n * h;
+        rhs(tnew, ynew, fnew);
+
+        bool stop = step(t, y, k1, tnew, ynew, fnew);
+        t = tnew;
+        y = ynew;
+        k1 = fnew;
+        if (stop) break;
+    }
+
+    if (t_end) *t_end = t;
+    return y;
+}
+
+#endif // ODE_HPP
@@ -0,0 +1,199 @@
+#ifndef ORBIT_HPP
+#define ORBIT_HPP
+
+#include <cmath>
+#include "ode.hpp"
+
+/* Shared orbit models. Several can be used side by side in one program.
+ * State layout is x, y, vx, vy in SI units.
+ */
+
+// Orbit state: x, y, vx, vy
+typedef State<4> OrbitState;
+
+constexpr double G = 6.67430e-11; // Gravitational constant
+constexpr double M = 5.972e24;     // Mass of the Earth
+constexpr double ML = 7.342e22;    // Mass of the Moon
+constexpr double MS = 1.989e30;    // Mass of the Sun
+
+constexpr double moon_distance = 384400000.0; // Earth-Moon distance in meters
+constexpr double earth_radius = 6371000.0;     // Radius of the Earth in meters
+
+// Add the gradient of the point-mass acceleration -GM r / |r|^3 with
+// respect to position, at separation (dx, dy), to g
+inline void addPointMassGradient(double GM, double dx, double dy, Matrix<2> &g) {
+    double r2 = dx * dx + dy * dy;
+    double inv_r3 = 1.0 / (r2 * std::sqrt(r2));
+    double inv_r5 = inv_r3 / r2;
+    g[0][0] += -GM * (inv_r3 - 3.0 * dx * dx * inv_r5);
+    g[0][1] += 3.0 * GM * dx * dy * inv_r5;
+    g[1][0] += 3.0 * GM * dx * dy * inv_r5;
+    g[1][1] += -GM * (inv_r3 - 3.0 * dy * dy * inv_r5);
+}
+
+/* Orbit models as functors. Each declares its state dimension and keeps
+ * its constants at compile time, so passing a model (rather than a
+ * function pointer) to a stepper inlines the whole RHS into the step loop
+ * and folds G * M. operator() is the rhs, accel() the position-only
+ * acceleration for the symplectic steppers. Both work in the scalar type
+ * of the state (double, float or DoubleDouble from precision.hpp).
+ * gradient() is the analytic Jacobian d accel / d position, used by the
+ * variational equations (variational.hpp).
+ */
+
+// Earth only (pure two-body problem)
+struct EarthModel {
+    static constexpr std::size_t dim = 4;
+    static constexpr double GM = G * M;
+
+    template <typename Time, typename T>
+    void accel(Time /*t*/, const BasicState<T, 2> &q, BasicState<T, 2> &a) const {
+        using std::sqrt;
+        T r = sqrt(q[0] * q[0] + q[1] * q[1]);
+        T r_cubed = r * r * r;
+
+        a[0] = -T(GM) * q[0] / r_cubed;
+        a[1] = -T(GM) * q[1] / r_cubed;
+    }
+
+    void gradient(double /*t*/, const State<2> &q, Matrix<2> &g) const {
+        g = {};
+        addPointMassGradient(GM, q[0], q[1], g);
+    }
+
+    template <typename Time, typename T>
+    void operator()(Time t, const BasicState<T, 4> &yvec, BasicState<T, 4> &dydt) const {
+        BasicState<T, 2> a;
+        accel(t, BasicState<T, 2>{yvec[0], yvec[1]}, a);
+        dydt[0] = yvec[2];
+        dydt[1] = yvec[3];
+        dydt[2] = a[0];
+        dydt[3] = a[1];
+    }
+};
+
+// Earth plus the pull of a Moon fixed at (moon_distance, 0)
+struct EarthMoonModel {
+    static constexpr std::size_t dim = 4;
+    static constexpr double GM = G * M;    // Earth's gravitational parameter
+    static constexpr double GM_L = G * ML; // Moon's gravitational parameter
+
+    template <typename Time, typename T>
+    void accel(Time /*t*/, const BasicState<T, 2> &q, BasicState<T, 2> &a) const {
+        using std::sqrt;
+        T r = sqrt(q[0] * q[0] + q[1] * q[1]);
+        T r_cubed = r * r * r;
+
+        // Distance between the satellite and the Moon
+        T dx = q[0] - T(moon_distance);
+        T dy = q[1];
+        T r_moon = sqrt(dx * dx + dy * dy);
+        T r_moon_cubed = r_moon * r_moon * r_moon;
+
+        a[0] = -T(GM) * q[0] / r_cubed - T(GM_L) * dx / r_moon_cubed;
+        a[1] = -T(GM) * q[1] / r_cubed - T(GM_L) * dy / r_moon_cubed;
+    }
+
+    void gradient(double /*t*/, const State<2> &q, Matrix<2> &g) const {
+        g = {};
+        addPointMassGradient(GM, q[0], q[1], g);
+        addPointMassGradient(GM_L, q[0] - moon_distance, q[1], g);
+    }
+
+    template <typename Time, typename T>
+    void operator()(Time t, const BasicState<T, 4> &yvec, BasicState<T, 4> &dydt) const {
+        BasicState<T, 2> a;
+        accel(t, BasicState<T, 2>{yvec[0], yvec[1]}, a);
+        dydt[0] = yvec[2];
+        dydt[1] = yvec[3];
+        dydt[2] = a[0];
+        dydt[3] = a[1];
+    }
+};
+
+// Custom central body with its parameter chosen at run time
+struct PointMassModel {
+    static constexpr std::size_t dim = 4;
+    double GM;
+
+    explicit PointMassModel(double GM) : GM(GM) {}
+
+    template <typename Time, typename T>
+    void accel(Time /*t*/, const BasicState<T, 2> &q, BasicState<T, 2> &a) const {
+        using std::sqrt;
+        T r = sqrt(q[0] * q[0] + q[1] * q[1]);
+        T r_cubed = r * r * r;
+
+        a[0] = -T(GM) * q[0] / r_cubed;
+        a[1] = -T(GM) * q[1] / r_cubed;
+    }
+
+    void gradient(double /*t*/, const State<2> &q, Matrix<2> &g) const {
+        g = {};
+        addPointMassGradient(GM, q[0], q[1], g);
+    }
+
+    template <typename Time, typename T>
+    void operator()(Time t, const BasicState<T, 4> &yvec, BasicState<T, 4> &dydt) const {
+        BasicState<T, 2> a;
+        accel(t, BasicState<T, 2>{yvec[0], yvec[1]}, a);
+        dydt[0] = yvec[2];
+        dydt[1] = yvec[3];
+        dydt[2] = a[0];
+        dydt[3] = a[1];
+    }
+};
+
+// Plain-function forms of the models, for code that wants an RhsFunction
+inline void rhs_earth(double t, const OrbitState &yvec, OrbitState &dydt) {
+    EarthModel()(t, yvec, dydt);
+}
+
+inline void rhs_with_moon(double t, const OrbitState &yvec, OrbitState &dydt) {
+    EarthMoonModel()(t, yvec, dydt);
+}
+
+inline void accel_earth(double t, const State<2> &q, State<2> &a) {
+    EarthModel().accel(t, q, a);
+}
+
+inline void accel_with_moon(double t, const State<2> &q, State<2> &a) {
+    EarthMoonModel().accel(t, q, a);
+}
+
+// Specific orbital energy (per unit satellite mass) in the Earth-only field
+inline double energy_earth(const OrbitState &y) {
+    double r = std::sqrt(y[0] * y[0] + y[1] * y[1]);
+    return 0.5 * (y[2] * y[2] + y[3] * y[3]) - G * M / r;
+}
+
+// Specific energy with the fixed Moon included (still conserved)
+inline double energy_with_moon(const OrbitState &y) {
+    double dx = y[0] - moon_distance;
+    double r_moon = std::sqrt(dx * dx + y[1] * y[1]);
+    return energy_earth(y) - G * ML / r_moon;
+}
+
+// Specific angular momentum about the Earth (conserved for Earth only)
+inline double angular_momentum(const OrbitState &y) {
+    return y[0] * y[3] - y[1] * y[2];
+}
+
+// Event functions (see events.hpp)
+
+// Zero when the satellite crosses the Moon's x, rising outwards
+inline double event_moon_x(double /*t*/, const OrbitState &y) {
+    return y[0] - moon_distance;
+}
+
+// Zero at the Earth's surface, falling on impact
+inline double event_earth_impact(double /*t*/, const OrbitState &y) {
+    return std::sqrt(y[0] * y[0] + y[1] * y[1]) - earth_radius;
+}
+
+// Radial velocity r.v: rising through zero at periapsis, falling at apoapsis
+inline double event_apsis(double /*t*/, const OrbitState &y) {
+    return y[0] * y[2] + y[1] * y[3];
+}
+
+#endif // ORBIT_HPP
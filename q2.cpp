@@ -5,69 +5,10 @@
 #include <sstream>
 #include <fstream>
 #include <cmath>
-#include "interp.cpp"
+#include "q2.hpp"
 
 using namespace std;
-
-/* Read a file with GPS data formatted in 3 space-separated columns:
- * timestamp latitude longitude
- * and return the numerical data in the form of a single
- * valarray of size N*3. The data is read line-by line,
- * so that the value of row i and column j is stored in
- * the (3*i + j)-th component of the valarray
- */
-valarray<double> read_gps_data(const string &filename, int N)
-{
-    ifstream file(filename);
-    if (!file.is_open())
-    {
-        cerr << "Error: Unable to open file " << filename << endl;
-        return valarray<double>(); // Return empty valarray on error
-    }
-
-    valarray<double> data(N * 3);
-
-    string line;
-    int row = 0;
-    while (getline(file, line) && row < N)
-    {
-        stringstream ss(line);
-        string cell;
-        int col = 0;
-        while (getline(ss, cell, ' ') && col < 3)
-        {
-            try
-            {
-                data[row * 3 + col] = stod(cell);
-            }
-            catch (const invalid_argument &e)
-            {
-                cerr << "Error: Invalid data in file " << filename << " at row " << row << endl;
-                return valarray<double>(); // Return empty valarray on error
-            }
-            ++col;
-        }
-        ++row;
-    }
-    return data;
-}
-
-/* Function to calculate the distance between two latitude/longitude points using the Haversine formula */
-double haversine(double lat1, double lon1, double lat2, double lon2)
-{
-    const double R = 6371e3; // Earth's radius in meters
-    double phi1 = lat1 * M_PI / 180.0;
-    double phi2 = lat2 * M_PI / 180.0;
-    double delta_phi = (lat2 - lat1) * M_PI / 180.0;
-    double delta_lambda = (lon2 - lon1) * M_PI / 180.0;
-
-    double a = sin(delta_phi / 2) * sin(delta_phi / 2) +
-               cos(phi1) * cos(phi2) *
-                   sin(delta_lambda / 2) * sin(delta_lambda / 2);
-    double c = 2 * atan2(sqrt(a), sqrt(1 - a));
-
-    return R * c; // Distance in meters
-}
+using namespace q2;
 
 double calculate_avg_pace(const valarray<double> &lat_data, const valarray<double> &lon_data, double duration)
 {
@@ -107,28 +48,6 @@ double calculate_fastest_pace(const valarray<double> &lat_data, const valarray<d
     return fastest_pace;
 }
 
-/* Function to perform piecewise quadratic Lagrange interpolation */
-double interp_coords(valarray<double> &t_varr, valarray<double> &coord_varr, double t)
-{
-    size_t n = t_varr.size();
-    if (n < 3)
-    {
-        cerr << "Error: Not enough data points for quadratic interpolation." << endl;
-        return 0.0;
-    }
-
-    size_t i = 0;
-    while (i < n - 2 && t > t_varr[i + 2])
-    {
-        ++i;
-    }
-
-    valarray<double> t_segment = t_varr[slice(i, 3, 1)];
-    valarray<double> coord_segment = coord_varr[slice(i, 3, 1)];
-
-    return lagrange_interp(t_segment, coord_segment, t);
-}
-
 int main(int argc, char *argv[])
 {
     int Ndata = 1408;
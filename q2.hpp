@@ -0,0 +1,101 @@
+#ifndef Q2_HPP
+#define Q2_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <valarray>
+#include "interp.hpp"
+
+/* GPS track kernels of q2.cpp, shared with bench_kernels.cpp */
+namespace q2 {
+
+/* Read a file with GPS data formatted in 3 space-separated columns:
+ * timestamp latitude longitude
+ * and return the numerical data in the form of a single
+ * valarray of size N*3. The data is read line-by line,
+ * so that the value of row i and column j is stored in
+ * the (3*i + j)-th component of the valarray
+ */
+inline std::valarray<double> read_gps_data(const std::string &filename, int N)
+{
+    std::ifstream file(filename);
+    if (!file.is_open())
+    {
+        std::cerr << "Error: Unable to open file " << filename << std::endl;
+        return std::valarray<double>(); // Return empty valarray on error
+    }
+
+    std::valarray<double> data(N * 3);
+
+    std::string line;
+    int row = 0;
+    while (std::getline(file, line) && row < N)
+    {
+        std::stringstream ss(line);
+        std::string cell;
+        int col = 0;
+        while (std::getline(ss, cell, ' ') && col < 3)
+        {
+            try
+            {
+                data[row * 3 + col] = std::stod(cell);
+            }
+            catch (const std::invalid_argument &e)
+            {
+                std::cerr << "Error: Invalid data in file " << filename << " at row " << row << std::endl;
+                return std::valarray<double>(); // Return empty valarray on error
+            }
+            ++col;
+        }
+        ++row;
+    }
+    return data;
+}
+
+/* Function to calculate the distance between two latitude/longitude points using the Haversine formula */
+inline double haversine(double lat1, double lon1, double lat2, double lon2)
+{
+    const double R = 6371e3; // Earth's radius in meters
+    double phi1 = lat1 * M_PI / 180.0;
+    double phi2 = lat2 * M_PI / 180.0;
+    double delta_phi = (lat2 - lat1) * M_PI / 180.0;
+    double delta_lambda = (lon2 - lon1) * M_PI / 180.0;
+
+    double a = std::sin(delta_phi / 2) * std::sin(delta_phi / 2) +
+               std::cos(phi1) * std::cos(phi2) *
+                   std::sin(delta_lambda / 2) * std::sin(delta_lambda / 2);
+    double c = 2 * std::atan2(std::sqrt(a), std::sqrt(1 - a));
+
+    return R * c; // Distance in meters
+}
+
+/* Function to perform piecewise quadratic Lagrange interpolation */
+inline double interp_coords(std::valarray<double> &t_varr, std::valarray<double> &coord_varr, double t)
+{
+    std::size_t n = t_varr.size();
+    if (n < 3)
+    {
+        std::cerr << "Error: Not enough data points for quadratic interpolation." << std::endl;
+        return 0.0;
+    }
+
+    std::size_t i = 0;
+    while (i < n - 2 && t > t_varr[i + 2])
+    {
+        ++i;
+    }
+
+    std::valarray<double> t_segment = t_varr[std::slice(i, 3, 1)];
+    std::valarray<double> coord_segment = coord_varr[std::slice(i, 3, 1)];
+
+    return lagrange_interp(t_segment, coord_segment, t);
+}
+
+} // namespace q2
+
+#endif // Q2_HPP
@@ -0,0 +1,57 @@
+#ifndef Q2B_HPP
+#define Q2B_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <valarray>
+
+/* Segment distances of q2b.cpp (Haversine), shared with bench_kernels.cpp */
+namespace q2b {
+
+const double earthRadius = 6371000.0; // Average radius of the Earth in meters
+
+// Function to calculate distances between segments based on latitudes and longitudes
+inline std::valarray<double> coords_to_distances(const std::valarray<double> &lat, const std::valarray<double> &lon)
+{
+    // Check if the lengths of the lat and lon arrays match
+    if (lat.size() != lon.size())
+    {
+        std::cerr << "Error: Array lengths of lat and lon do not match." << std::endl;
+        exit(-1);
+    }
+
+    size_t N = lat.size(); // Number of points (segments = N-1)
+
+    // Initialize array to store distances between segments
+    std::valarray<double> distances(N - 1);
+
+    // Calculate distances for each segment using the Haversine formula
+    for (size_t i = 0; i < N - 1; ++i)
+    {
+        // Convert latitudes and longitudes from degrees to radians
+        double lat1_rad = lat[i] * M_PI / 180.0;
+        double lon1_rad = lon[i] * M_PI / 180.0;
+        double lat2_rad = lat[i + 1] * M_PI / 180.0;
+        double lon2_rad = lon[i + 1] * M_PI / 180.0;
+
+        // Calculate differences in latitudes and longitudes
+        double dlat_rad = lat2_rad - lat1_rad;
+        double dlon_rad = lon2_rad - lon1_rad;
+
+        // Apply Haversine formula to calculate distance between two points
+        double a = pow(sin(dlat_rad / 2), 2) +
+                   cos(lat1_rad) * cos(lat2_rad) * pow(sin(dlon_rad / 2), 2);
+        double c = 2 * atan2(sqrt(a), sqrt(1 - a));
+
+        // Calculate distance in meters using Earth's radius
+        distances[i] = earthRadius * c;
+    }
+
+    return distances;
+}
+
+} // namespace q2b
+
+#endif // Q2B_HPP
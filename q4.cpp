@@ -1,75 +1,33 @@
 #include <iostream>
-#include <fstream>
 #include <cmath>
-#include <valarray>
-#include "q3-4.hpp"
+#include <fstream>
+#include "orbit.hpp"
+#include "trajectory.hpp"
+#include "async_writer.hpp"
+#include "instrument.hpp"
 
 using namespace std;
 
-const double G = 6.67430e-11; // Gravitational constant
-const double M = 5.972e24;     // Mass of the Earth
-
-// Define the RHS function for ODEs
-valarray<double> rhs(double t, valarray<double> yvec) {
-    // Implement the RHS of the ODEs here
-    valarray<double> dydt(yvec.size());
-
-    double GM = G * M;
-    double x = yvec[0];
-    double y = yvec[1];
-    double vx = yvec[2];
-    double vy = yvec[3];
-
-    double r = sqrt(x * x + y * y);
-    double r_cubed = r * r * r;
-
-    dydt[0] = vx;
-    dydt[1] = vy;
-    dydt[2] = -GM * x / r_cubed;
-    dydt[3] = -GM * y / r_cubed;
-
-    return dydt;
-}
-
 // Euler's method
-valarray<double> euler(double t0, valarray<double> y0, double h, double tf) {
-    double t = t0;
-    valarray<double> y = y0;
-
+OrbitState euler(double t0, const OrbitState &y0, double h, double tf, IntegratorStats &st) {
     // Evolution loop for Euler's method
-    ofstream outFile("euler_output.dat");
-    while (t < tf) {
-        y += h * rhs(t, y);
-        t += h;
-        outFile << t << " " << y[0] << " " << y[1] << " " << y[2] << " " << y[3] << endl;
-    }
+    AsyncWriter<4, TrajectoryWriter> outFile("euler_output.traj");
+    OrbitState y = instrumentedRun(st, [&] {
+        return euler(instrumentRhs(rhs_earth, st), t0, y0, h, tf, instrumentStepOutput(outFile.output(), st, t0));
+    });
     outFile.close();
 
     return y;
 }
 
 // Runge-Kutta 4th order method
-valarray<double> rungeKutta4(double t0, valarray<double> y0, double h, double tf) {
-    double t = t0;
-    valarray<double> y = y0;
-    valarray<double> k1, k2, k3, k4;
-
+OrbitState rungeKutta4(double t0, const OrbitState &y0, double h, double tf, IntegratorStats &st) {
     // Evolution loop for 4th order Runge-Kutta
-    ofstream outFile("rk4_output.dat");
-    while (t < tf) {
-        k1 = h * rhs(t, y);
-        k2 = h * rhs(t + h / 2.0, y + k1 / 2.0);
-        k3 = h * rhs(t + h / 2.0, y + k2 / 2.0);
-        k4 = h * rhs(t + h, y + k3);
-
-        // Update y using the weighted average of slopes
-        y += (k1 + 2.0 * k2 + 2.0 * k3 + k4) / 6.0;
-
-        // Move to the next step
-        t += h;
-
-        outFile << t << " " << y[0] << " " << y[1] << " " << y[2] << " " << y[3] << endl;
-    }
+    AsyncWriter<4, TrajectoryWriter> outFile("rk4_output.traj");
+    OrbitState y = instrumentedRun(st, [&] {
+        return rungeKutta4(instrumentRhs(rhs_earth, st), t0, y0, h, tf,
+                           instrumentStepOutput(outFile.output(), st, t0));
+    });
     outFile.close();
 
     return y;
@@ -78,15 +36,28 @@ valarray<double> rungeKutta4(double t0, valarray<double> y0, double h, double tf
 int main() {
     // Initial conditions
     double t0 = 0.0;
-    valarray<double> y0 = {0.0, 26378100.0, 3887.3, 0.0}; // x0, y0, vx0, vy0
+    OrbitState y0 = {0.0, 26378100.0, 3887.3, 0.0}; // x0, y0, vx0, vy0
     double h = 1.0; // Time step
     double tf = 10000.0; // Final time (10000 seconds)
 
+    // Statistics of both runs, written when built with -DORBIT_STATS
+    IntegratorStats euler_stats, rk4_stats;
+    euler_stats.timed = rk4_stats.timed = true; // Also time the rhs and output calls
+
     // Solve using Euler's method
-    valarray<double> y_euler = euler(t0, y0, h, tf);
+    euler(t0, y0, h, tf, euler_stats); // Writes euler_output.traj
 
     // Solve using Runge-Kutta 4th order method
-    valarray<double> y_rk4 = rungeKutta4(t0, y0, h, tf);
+    rungeKutta4(t0, y0, h, tf, rk4_stats); // Writes rk4_output.traj
+
+    if (IntegratorStats::enabled) {
+        ofstream stats("q4_stats.json");
+        stats << "[";
+        writeStatsJson(stats, "euler", euler_stats);
+        stats << ",\n ";
+        writeStatsJson(stats, "rk4", rk4_stats);
+        stats << "]\n";
+    }
 
     return 0;
 }
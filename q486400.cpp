@@ -1,96 +1,97 @@
 #include <iostream>
-#include <fstream>
 #include <cmath>
-#include <valarray>
-#include "q3-4.hpp"
+#include "orbit.hpp"
+#include "dense.hpp"
+#include "kepler.hpp"
+#include "trajectory.hpp"
+#include "async_writer.hpp"
+#include <vector>
+#include <algorithm>
 
 using namespace std;
 
-const double G = 6.67430e-11; // Gravitational constant
-const double M = 5.972e24;     // Mass of the Earth
-
-// Define the RHS function for ODEs
-valarray<double> rhs(double t, valarray<double> yvec) {
-    // Implement the RHS of the ODEs here
-    valarray<double> dydt(yvec.size());
-
-    double GM = G * M;
-    double x = yvec[0];
-    double y = yvec[1];
-    double vx = yvec[2];
-    double vy = yvec[3];
-
-    double r = sqrt(x * x + y * y);
-    double r_cubed = r * r * r;
-
-    dydt[0] = vx;
-    dydt[1] = vy;
-    dydt[2] = -GM * x / r_cubed;
-    dydt[3] = -GM * y / r_cubed;
-
-    return dydt;
-}
-
 // Euler's method
-valarray<double> euler(double t0, valarray<double> y0, double h, double tf) {
-    double t = t0;
-    valarray<double> y = y0;
-
+OrbitState euler(double t0, const OrbitState &y0, double h, double tf) {
     // Evolution loop for Euler's method
-    ofstream outFile("euler_output86.dat");
-    while (t < tf) {
-        y += h * rhs(t, y);
-        t += h;
-        if (fmod(t, 60.0) == 0) { // Print every 60 seconds
-            outFile << t << " " << y[0] << " " << y[1] << " " << y[2] << " " << y[3] << endl;
+    // Print every 60 seconds, counted in steps so that round-off in t
+    // cannot skip or repeat a sample
+    AsyncWriter<4, TrajectoryWriter> outFile("euler_output86.traj");
+    const long stride = max(1L, lround(60.0 / h));
+    long k = 0;
+    OrbitState y = euler(EarthModel(), t0, y0, h, tf, [&](double t, const OrbitState &yt) {
+        if (++k % stride == 0) {
+            outFile.write(t, yt);
         }
-    }
+    });
     outFile.close();
 
     return y;
 }
 
 // Runge-Kutta 4th order method
-valarray<double> rungeKutta4(double t0, valarray<double> y0, double h, double tf) {
-    double t = t0;
-    valarray<double> y = y0;
-    valarray<double> k1, k2, k3, k4;
-
-    // Evolution loop for 4th order Runge-Kutta
-    ofstream outFile("rk4_output86.dat");
-    while (t < tf) {
-        k1 = h * rhs(t, y);
-        k2 = h * rhs(t + h / 2.0, y + k1 / 2.0);
-        k3 = h * rhs(t + h / 2.0, y + k2 / 2.0);
-        k4 = h * rhs(t + h, y + k3);
-
-        // Update y using the weighted average of slopes
-        y += (k1 + 2.0 * k2 + 2.0 * k3 + k4) / 6.0;
-
-        // Move to the next step
-        t += h;
-
-        if (fmod(t, 60.0) == 0) { // Print every 60 seconds
-            outFile << t << " " << y[0] << " " << y[1] << " " << y[2] << " " << y[3] << endl;
-        }
-    }
+OrbitState rungeKutta4(double t0, const OrbitState &y0, double h, double tf) {
+    // Evolution loop for 4th order Runge-Kutta, sampled every 60 seconds
+    // by dense output whatever the step size
+    AsyncWriter<4, TrajectoryWriter> outFile("rk4_output86.traj");
+    OrbitState y = rungeKutta4Dense(EarthModel(), t0, y0, h, tf, 60.0, outFile.output());
     outFile.close();
 
     return y;
 }
 
+// Closed-form two-body solution on the same 60 second grid: no stepping
+OrbitState kepler(double t0, const OrbitState &y0, double tf) {
+    vector<double> times;
+    for (int k = 1; t0 + k * 60.0 <= tf; ++k) times.push_back(t0 + k * 60.0);
+
+    vector<OrbitState> states;
+    KeplerOrbit(y0, G * M, t0).states(times, states);
+
+    TrajectoryWriter outFile("kepler_output86.traj");
+    for (size_t k = 0; k < times.size(); ++k) outFile.write(times[k], states[k]);
+    outFile.close();
+
+    return states.empty() ? y0 : states.back();
+}
+
+// The propagator must return y0 itself at t0, one-shot and batched; the
+// hyperbolic initial guess is the case that can break there
+void kepler_check(const OrbitState &y0) {
+    auto report = [](const char *name, const OrbitState &y, const OrbitState &y_start) {
+        cout << "Kepler at dt = 0 (" << name << "): |r - r0| = " << hypot(y[0] - y_start[0], y[1] - y_start[1])
+             << " m, |v - v0| = " << hypot(y[2] - y_start[2], y[3] - y_start[3]) << " m/s" << endl;
+    };
+    OrbitState y_hyp0 = {y0[0], y0[1], 8000.0, 0.0}; // Above escape speed
+    vector<OrbitState> states;
+    KeplerOrbit(y_hyp0, G * M).states({0.0, 60.0}, states);
+
+    report("elliptic", keplerPropagate(y0, G * M, 0.0), y0);
+    report("hyperbolic", keplerPropagate(y_hyp0, G * M, 0.0), y_hyp0);
+    report("hyperbolic, batched", states[0], y_hyp0);
+}
+
 int main() {
     // Initial conditions
     double t0 = 0.0;
-    valarray<double> y0 = {0.0, 26378100.0, 3887.3, 0.0}; // x0, y0, vx0, vy0
+    OrbitState y0 = {0.0, 26378100.0, 3887.3, 0.0}; // x0, y0, vx0, vy0
     double h = 60.0; // Time step (60 seconds)
     double tf = 86400.0; // Final time (86400 seconds)
 
     // Solve using Euler's method
-    valarray<double> y_euler = euler(t0, y0, h, tf);
+    OrbitState y_euler = euler(t0, y0, h, tf);
 
     // Solve using Runge-Kutta 4th order method
-    valarray<double> y_rk4 = rungeKutta4(t0, y0, h, tf);
+    OrbitState y_rk4 = rungeKutta4(t0, y0, h, tf);
+
+    // Exact solution for the Earth-only problem
+    OrbitState y_kepler = kepler(t0, y0, tf);
+
+    // Drift of the steppers from the exact orbit at tf
+    cout << "Position error at t = " << tf << " s vs the Kepler solution:" << endl;
+    cout << "Euler: " << hypot(y_euler[0] - y_kepler[0], y_euler[1] - y_kepler[1]) << " m" << endl;
+    cout << "RK4:   " << hypot(y_rk4[0] - y_kepler[0], y_rk4[1] - y_kepler[1]) << " m" << endl;
+
+    kepler_check(y0);
 
     return 0;
 }
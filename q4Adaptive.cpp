@@ -0,0 +1,94 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include "orbit.hpp"
+#include "adaptive.hpp"
+#include "dense.hpp"
+#include <vector>
+
+using namespace std;
+
+/* Compare fixed-step rungeKutta4 with the adaptive Dormand-Prince stepper
+ * on the Earth-only and Earth+Moon problems. The reference solution is a
+ * very tight tolerance adaptive run; we report the final position error
+ * against the number of rhs evaluations each method needed.
+ */
+
+double position_error(const OrbitState &a, const OrbitState &b) {
+    return sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]));
+}
+
+// A run cut short by opt.max_steps is no result at tf
+bool reached(const AdaptiveStats &stats, double tf) {
+    if (!stats.reached_tf) cerr << "Error: dopri5 ran out of steps before tf = " << tf << " s" << endl;
+    return stats.reached_tf;
+}
+
+void compare(const char *name, RhsFunction<4> rhs, const OrbitState &y0, double tf) {
+    double t0 = 0.0;
+
+    AdaptiveOptions ref_opt;
+    ref_opt.atol = 1e-9;
+    ref_opt.rtol = 1e-14;
+    AdaptiveStats ref_stats;
+    OrbitState y_ref = dormandPrince45(rhs, t0, y0, tf, ref_opt, &ref_stats);
+    if (!reached(ref_stats, tf)) return;
+
+    cout << name << " (tf = " << tf << " s)" << endl;
+    cout << setw(24) << "method" << setw(14) << "rhs evals" << setw(16) << "pos error [m]" << endl;
+
+    double steps[] = {600.0, 120.0, 60.0, 10.0};
+    for (double h : steps) {
+        OrbitState y = rungeKutta4(rhs, t0, y0, h, tf);
+        long evals = 4 * static_cast<long>(ceil((tf - t0) / h));
+        cout << setw(18) << "rk4 h = " << setw(6) << h << setw(14) << evals << setw(16)
+             << position_error(y, y_ref) << endl;
+    }
+
+    double rtols[] = {1e-6, 1e-8, 1e-10, 1e-12};
+    for (double rtol : rtols) {
+        AdaptiveOptions opt;
+        opt.atol = rtol;
+        opt.rtol = rtol;
+        AdaptiveStats stats;
+        OrbitState y = dormandPrince45(rhs, t0, y0, tf, opt, &stats);
+        if (!reached(stats, tf)) continue;
+        cout << setw(18) << "dopri5 rtol = " << setw(6) << rtol << setw(14) << stats.rhs_evals << setw(16)
+             << position_error(y, y_ref) << "  (" << stats.accepted << " accepted, " << stats.rejected
+             << " rejected)" << endl;
+    }
+    cout << endl;
+}
+
+// Sample the adaptive solution on the 60 s reporting grid with dense output
+// and compare against small-step RK4 samples on the same grid
+void dense_check(RhsFunction<4> rhs, const OrbitState &y0, double tf) {
+    vector<OrbitState> ref, dense;
+    rungeKutta4Dense(rhs, 0.0, y0, 1.0, tf, 60.0, [&](double, const OrbitState &y) { ref.push_back(y); });
+
+    AdaptiveOptions opt;
+    opt.atol = opt.rtol = 1e-10;
+    AdaptiveStats stats;
+    dormandPrince45Dense(rhs, 0.0, y0, tf, 60.0, [&](double, const OrbitState &y) { dense.push_back(y); }, opt,
+                         &stats);
+    if (!reached(stats, tf)) return;
+
+    double max_err = 0.0;
+    for (size_t i = 0; i < min(ref.size(), dense.size()); ++i) max_err = max(max_err, position_error(ref[i], dense[i]));
+    cout << "Dense output on a 60 s grid: " << dense.size() << " samples from " << stats.accepted
+         << " adaptive steps, max pos error " << max_err << " m" << endl;
+}
+
+int main() {
+    // Initial conditions from q4.cpp
+    OrbitState y0 = {0.0, 26378100.0, 3887.3, 0.0}; // x0, y0, vx0, vy0
+    // Faster launch on a long, eccentric orbit reaching well past GEO
+    OrbitState y0_fast = {0.0, 26378100.0, 5400.0, 0.0};
+
+    compare("Earth only", rhs_earth, y0, 86400.0);
+    compare("Earth + Moon", rhs_with_moon, y0, 86400.0);
+    compare("Earth + Moon, high apogee", rhs_with_moon, y0_fast, 10 * 86400.0);
+    dense_check(rhs_with_moon, y0, 86400.0);
+
+    return 0;
+}
@@ -1,43 +1,41 @@
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <sstream>
+#include "mapped_trajectory.hpp"
 
 using namespace std;
 
 void printLastLineDetails(const string& filename) {
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cerr << "Error opening file: " << filename << endl;
+    // Only the pages holding the last row are read
+    MappedTrajectory traj;
+    if (!traj.open(filename)) return;
+    if (traj.rows() == 0) {
+        cerr << "Empty trajectory: " << filename << endl;
         return;
     }
-
-    string lastLine, line;
-    while (getline(file, line)) {
-        lastLine = line;
+    if (traj.columns() < 5) {
+        cerr << "Expected t, x, y, vx, vy columns: " << filename << endl;
+        return;
     }
 
-    stringstream ss(lastLine);
-    int N;
-    double Rx, Ry, Vx, Vy;
-    string TF;
-
-    // Extract values from the last line
-    ss >> TF >> Rx >> Ry >> Vx >> Vy >> N;
+    // Values from the last row
+    size_t last = traj.rows() - 1;
+    double TF = traj.value(0, last);
+    double Rx = traj.value(1, last);
+    double Ry = traj.value(2, last);
+    double Vx = traj.value(3, last);
+    double Vy = traj.value(4, last);
 
     // Print details
     cout << filename << endl;
     cout << "TF is " << TF << " rx = " << Rx << " ry = " << Ry << " vx = " << Vx << " vy =  " << Vy << endl;
-
-    file.close();
 }
 
 int main() {
-    // Print details of last line of euler_output.dat
-    printLastLineDetails("euler_output.dat");
-    printLastLineDetails("euler_output86.dat");
-    printLastLineDetails("rk4_output.dat");
-    printLastLineDetails("rk4_output86.dat");
+    // Print details of last line of euler_output.traj
+    printLastLineDetails("euler_output.traj");
+    printLastLineDetails("euler_output86.traj");
+    printLastLineDetails("rk4_output.traj");
+    printLastLineDetails("rk4_output86.traj");
 
     return 0;
 }
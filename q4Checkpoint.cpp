@@ -0,0 +1,90 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "orbit.hpp"
+#include "checkpoint.hpp"
+
+using namespace std;
+
+/* Extending a run with checkpoints instead of starting over. For RK4,
+ * dopri5 and ABM6 on the Earth+Moon problem: integrate to tf saving a
+ * checkpoint file four times, reload the file as after a crash and extend
+ * to 2 tf. Compares the result and the cost with one run from t0 to 2 tf.
+ * A save is a file write plus rename (~0.1 ms), about as much as a day of
+ * RK4 here, so the interval should be long compared with that.
+ *
+ * Usage: q4Checkpoint.exe [tf in days]
+ */
+
+template <typename Run>
+double seconds(Run run) {
+    auto start = chrono::steady_clock::now();
+    run();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    double days = argc > 1 ? atof(argv[1]) : 10.0;
+    double t0 = 0.0, tf = days * 86400.0, h = 60.0;
+    OrbitState y0 = {0.0, 26378100.0, 3887.3, 0.0}; // x0, y0, vx0, vy0
+
+    AdaptiveOptions opt;
+    opt.atol = opt.rtol = 1e-12;
+    CheckpointOptions copt;
+    copt.path = "orbit.ckpt";
+    copt.interval = tf / 4.0;
+
+    cout << "Extending " << days << " days to " << 2 * days << " days (Earth + Moon)" << endl;
+    cout << setw(8) << "method" << setw(16) << "from t0 [ms]" << setw(16) << "extend [ms]" << setw(18)
+         << "difference [m]" << endl;
+
+    CheckpointMethod methods[] = {CheckpointMethod::RK4, CheckpointMethod::Dopri5, CheckpointMethod::ABM};
+    const char *names[] = {"rk4", "dopri5", "abm6"};
+    for (int k = 0; k < 3; ++k) {
+        auto advance = [&](Checkpoint<4> &ck, double t_end, const CheckpointOptions &c) {
+            if (ck.method == CheckpointMethod::RK4) return rungeKutta4Checkpointed(EarthMoonModel(), ck, t_end, c);
+            if (ck.method == CheckpointMethod::Dopri5) {
+                OrbitState y = dormandPrince45Checkpointed(EarthMoonModel(), ck, t_end, c, opt);
+                if (!ck.stats.reached_tf) {
+                    cerr << "Error: dopri5 ran out of steps at t = " << ck.t << " s, short of " << t_end << " s"
+                         << endl;
+                    exit(1);
+                }
+                return y;
+            }
+            return adamsBashforthMoultonCheckpointed(EarthMoonModel(), ck, t_end, c);
+        };
+        auto start = [&] {
+            Checkpoint<4> ck(methods[k], t0, y0, methods[k] == CheckpointMethod::Dopri5 ? 0.0 : h);
+            ck.order = 6;
+            return ck;
+        };
+
+        // Reference: straight through to 2 tf
+        OrbitState y_ref;
+        double full_s = seconds([&] {
+            Checkpoint<4> ck = start();
+            y_ref = advance(ck, 2.0 * tf, CheckpointOptions());
+        });
+
+        // First leg to tf with daily checkpoints, then resume from the file
+        Checkpoint<4> first = start();
+        advance(first, tf, copt);
+
+        OrbitState y_ext;
+        double ext_s = seconds([&] {
+            Checkpoint<4> ck;
+            if (!loadCheckpoint(copt.path, ck)) exit(1);
+            y_ext = advance(ck, 2.0 * tf, copt);
+        });
+
+        cout << setw(8) << names[k] << setw(16) << full_s * 1e3 << setw(16) << ext_s * 1e3 << setw(18)
+             << hypot(y_ext[0] - y_ref[0], y_ext[1] - y_ref[1]) << endl;
+    }
+
+    remove(copt.path.c_str());
+    return 0;
+}
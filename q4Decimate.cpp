@@ -0,0 +1,77 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cmath>
+#include <chrono>
+#include <string>
+#include "orbit.hpp"
+#include "decimation.hpp"
+
+using namespace std;
+
+/* Decimated trajectory output (decimation.hpp) on a one day RK4 run with
+ * h = 1 s. Writes every step to rk4_outputFull.traj and, for a range of
+ * position tolerances, only the states Hermite interpolation needs to
+ * rk4_outputDecimated.traj. Each decimated file is read back and the
+ * reconstruction compared with every stored step.
+ *
+ * Usage: q4Decimate.exe [days]
+ */
+
+long fileSize(const string &path) {
+    ifstream in(path, ios::binary | ios::ate);
+    return in.is_open() ? static_cast<long>(in.tellg()) : -1;
+}
+
+int main(int argc, char *argv[]) {
+    double days = argc > 1 ? atof(argv[1]) : 1.0;
+    double t0 = 0.0, h = 1.0, tf = days * 86400.0;
+    OrbitState y0 = {0.0, 26378100.0, 3887.3, 0.0}; // x0, y0, vx0, vy0
+
+    {
+        TrajectoryWriter full("rk4_outputFull.traj");
+        rungeKutta4(EarthModel(), t0, y0, h, tf, full.output());
+    }
+    Trajectory ref;
+    if (!readTrajectory("rk4_outputFull.traj", ref)) return 1;
+    long full_bytes = fileSize("rk4_outputFull.traj");
+
+    auto start = chrono::steady_clock::now();
+    rungeKutta4(EarthModel(), t0, y0, h, tf);
+    double plain_s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "RK4 h = " << h << " s for " << days << " days: " << ref.rows() << " rows, " << full_bytes
+         << " bytes" << endl;
+    cout << setw(10) << "tol [m]" << setw(10) << "kept" << setw(12) << "bytes" << setw(10) << "ratio"
+         << setw(16) << "max pos [m]" << setw(16) << "max vel [m/s]" << setw(16) << "cost [ns/step]" << endl;
+
+    double tols[] = {1e-3, 1e-2, 1e-1, 1.0, 10.0, 100.0};
+    for (double tol : tols) {
+        DecimationOptions opt;
+        opt.position_tol = tol;
+        size_t kept;
+        start = chrono::steady_clock::now();
+        {
+            Decimator<4, TrajectoryWriter> out(opt, "rk4_outputDecimated.traj");
+            rungeKutta4(EarthModel(), t0, y0, h, tf, out.output());
+            out.close();
+            kept = out.kept();
+        }
+        double s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        DecimatedTrajectory<4> dec;
+        if (!readDecimated("rk4_outputDecimated.traj", dec)) return 1;
+        double max_pos = 0.0, max_vel = 0.0;
+        OrbitState y;
+        for (size_t r = 0; r < ref.rows(); ++r) {
+            dec.state(ref.columns[0][r], y);
+            max_pos = max(max_pos, hypot(y[0] - ref.columns[1][r], y[1] - ref.columns[2][r]));
+            max_vel = max(max_vel, hypot(y[2] - ref.columns[3][r], y[3] - ref.columns[4][r]));
+        }
+        long bytes = fileSize("rk4_outputDecimated.traj");
+        cout << setw(10) << tol << setw(10) << kept << setw(12) << bytes << setw(10) << setprecision(3)
+             << double(full_bytes) / bytes << setw(16) << max_pos << setw(16) << max_vel << setw(16)
+             << (s - plain_s) * 1e9 / ref.rows() << setprecision(6) << endl;
+    }
+    return 0;
+}
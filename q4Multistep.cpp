@@ -0,0 +1,58 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include "orbit.hpp"
+#include "adaptive.hpp"
+#include "multistep.hpp"
+
+using namespace std;
+
+/* rhs calls against accuracy for RK4 and Adams-Bashforth-Moulton on a
+ * 10 day Earth+Moon run. The reference is a tight-tolerance dopri5 run.
+ */
+
+double position_error(const OrbitState &a, const OrbitState &b) {
+    return hypot(a[0] - b[0], a[1] - b[1]);
+}
+
+int main() {
+    // Initial conditions from q4.cpp
+    OrbitState y0 = {0.0, 26378100.0, 3887.3, 0.0}; // x0, y0, vx0, vy0
+    double t0 = 0.0, tf = 10 * 86400.0;
+
+    AdaptiveOptions ref_opt;
+    ref_opt.atol = 1e-12;
+    ref_opt.rtol = 1e-14;
+    OrbitState y_ref = dormandPrince45(rhs_with_moon, t0, y0, tf, ref_opt);
+
+    cout << "Earth + Moon, tf = 10 days" << endl;
+    cout << setw(12) << "method" << setw(8) << "h [s]" << setw(12) << "rhs evals" << setw(16) << "pos error [m]"
+         << endl;
+
+    double steps[] = {240.0, 120.0, 60.0, 30.0};
+    for (double h : steps) {
+        OrbitState y = rungeKutta4(rhs_with_moon, t0, y0, h, tf);
+        long evals = 4 * static_cast<long>(ceil((tf - t0) / h));
+        cout << setw(12) << "rk4" << setw(8) << h << setw(12) << evals << setw(16) << position_error(y, y_ref)
+             << endl;
+    }
+
+    struct Config {
+        const char *name;
+        int order;
+        bool final_eval;
+    };
+    Config configs[] = {{"abm4 PECE", 4, true}, {"abm6 PECE", 6, true}, {"abm8 PECE", 8, true},
+                        {"abm6 PEC", 6, false}};
+    for (const Config &c : configs) {
+        for (double h : steps) {
+            long evals = 0;
+            OrbitState y = adamsBashforthMoulton(rhs_with_moon, t0, y0, h, tf, c.order, c.final_eval, NoOutput(),
+                                                 &evals);
+            cout << setw(12) << c.name << setw(8) << h << setw(12) << evals << setw(16) << position_error(y, y_ref)
+                 << endl;
+        }
+    }
+
+    return 0;
+}
@@ -1,75 +1,22 @@
 #include <iostream>
-#include <fstream>
 #include <cmath>
-#include <valarray>
+#include <chrono>
+#include "q3-4.hpp"
+#include "orbit.hpp"
+#include "dense.hpp"
+#include "ephemeris.hpp"
+#include "trajectory.hpp"
 
 using namespace std;
 
-const double G = 6.67430e-11; // Gravitational constant
-const double M = 5.972e24;     // Mass of the Earth
-const double ML = 7.342e22;    // Mass of the Moon
-
-// Define the RHS function for ODEs with Moon's gravitational effect
-valarray<double> rhs_with_moon(double t, valarray<double> yvec) {
-    // Implement the RHS of the ODEs here
-    valarray<double> dydt(yvec.size());
-
-    double GM = G * M; // Earth's gravitational parameter
-    double GM_L = G * ML; // Moon's gravitational parameter
-    double x = yvec[0];
-    double y = yvec[1];
-    double vx = yvec[2];
-    double vy = yvec[3];
-
-    double r = sqrt(x * x + y * y);
-    double r_cubed = r * r * r;
-
-    // Position of the Moon
-    double xL = 384400000.0; // x position of the Moon
-    double yL = 0.0; // y position of the Moon
-
-    // Distance between the satellite and the Moon
-    double dx = x - xL;
-    double dy = y - yL;
-    double r_moon = sqrt(dx * dx + dy * dy);
-    double r_moon_cubed = r_moon * r_moon * r_moon;
-
-    // Gravitational effect of the Moon
-    double ax_moon = -GM_L * dx / r_moon_cubed;
-    double ay_moon = -GM_L * dy / r_moon_cubed;
-
-    dydt[0] = vx;
-    dydt[1] = vy;
-    dydt[2] = (-GM * x / r_cubed) + ax_moon;
-    dydt[3] = (-GM * y / r_cubed) + ay_moon;
-
-    return dydt;
-}
-
-// Runge-Kutta 4th order method
-valarray<double> rungeKutta4(double t0, valarray<double> y0, double h, double tf) {
-    double t = t0;
-    valarray<double> y = y0;
-    valarray<double> k1, k2, k3, k4;
-
-    // Evolution loop for 4th order Runge-Kutta
-    ofstream outFile("rk4_outputMoon.dat");
-    while (t < tf) {
-        k1 = h * rhs_with_moon(t, y);
-        k2 = h * rhs_with_moon(t + h / 2.0, y + k1 / 2.0);
-        k3 = h * rhs_with_moon(t + h / 2.0, y + k2 / 2.0);
-        k4 = h * rhs_with_moon(t + h, y + k3);
-
-        // Update y using the weighted average of slopes
-        y += (k1 + 2.0 * k2 + 2.0 * k3 + k4) / 6.0;
-
-        // Move to the next step
-        t += h;
-
-        if (fmod(t, 60.0) == 0) { // Print every 60 seconds
-            outFile << t << " " << y[0] << " " << y[1] << " " << y[2] << " " << y[3] << endl;
-        }
-    }
+// Runge-Kutta 4th order method with the given orbit model
+// The model is a template parameter, so its RHS is inlined into the loop.
+template <typename Model>
+OrbitState rungeKutta4Output(Model model, double t0, const OrbitState &y0, double h, double tf, const char *filename) {
+    // Evolution loop for 4th order Runge-Kutta, sampled every 60 seconds
+    // by dense output whatever the step size
+    TrajectoryWriter outFile(filename);
+    OrbitState y = rungeKutta4Dense(model, t0, y0, h, tf, 60.0, outFile.output());
     outFile.close();
 
     return y;
@@ -78,12 +25,43 @@ valarray<double> rungeKutta4(double t0, valarray<double> y0, double h, double tf
 int main() {
     // Initial conditions
     double t0 = 0.0;
-    valarray<double> y0 = {0.0, 26378100.0, 3887.3, 0.0}; // x0, y0, vx0, vy0
+    OrbitState y0 = {0.0, 26378100.0, 3887.3, 0.0}; // x0, y0, vx0, vy0
     double h = 60.0; // Time step (60 seconds)
     double tf = 86400.0; // Final time (86400 seconds)
 
     // Solve using Runge-Kutta 4th order method with Moon's gravitational effect
-    valarray<double> y_rk4_with_moon = rungeKutta4(t0, y0, h, tf);
+    OrbitState y_rk4_with_moon = rungeKutta4Output(EarthMoonModel(), t0, y0, h, tf, "rk4_outputMoon.traj");
+
+    // Same run without the Moon (no output), to see how far it pulls the satellite
+    OrbitState y_rk4 = rungeKutta4(EarthModel(), t0, y0, h, tf);
+
+    cout << "Displacement due to the Moon after " << tf << " s: "
+         << hypot(y_rk4_with_moon[0] - y_rk4[0], y_rk4_with_moon[1] - y_rk4[1]) << " m" << endl;
+
+    // Moon moving along its orbit (from J2000.0), read from a Chebyshev
+    // ephemeris built once for the run; the Sun is added as well
+    ChebyshevEphemeris moon = moonEphemeris(t0, tf);
+    ChebyshevEphemeris sun = sunEphemeris(t0, tf);
+    OrbitState y_rk4_moving =
+        rungeKutta4Output(MovingMoonModel(moon, &sun), t0, y0, h, tf, "rk4_outputMovingMoon.traj");
+
+    cout << "Ephemeris fit error: Moon " << moon.maxError() << " m, Sun " << sun.maxError() << " m" << endl;
+    cout << "Moving vs fixed Moon after " << tf << " s: "
+         << hypot(y_rk4_moving[0] - y_rk4_with_moon[0], y_rk4_moving[1] - y_rk4_with_moon[1]) << " m" << endl;
+
+    // Cost of the step loop with the fixed and the moving Moon
+    const int repeats = 200;
+    double sink = 0.0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < repeats; ++i) sink += rungeKutta4(EarthMoonModel(), t0, y0, h, tf)[0];
+    double fixed_s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < repeats; ++i) sink += rungeKutta4(MovingMoonModel(moon, &sun), t0, y0, h, tf)[0];
+    double moving_s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    double steps = repeats * (tf - t0) / h;
+    cout << "RK4 step: fixed Moon " << fixed_s * 1e9 / steps << " ns, moving Moon + Sun " << moving_s * 1e9 / steps
+         << " ns (checksum " << sink << ")" << endl;
 
     return 0;
 }
@@ -0,0 +1,59 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include "orbit.hpp"
+#include "shooting.hpp"
+
+using namespace std;
+
+/* Shooting for the launch velocity (shooting.hpp): from the q4 starting
+ * point, find the initial (vx, vy) whose Earth+Moon RK4 orbit reaches the
+ * target point at tf, with the Jacobian from the variational equations and
+ * with Broyden updates. Starts from q4's 3887.3 m/s along x.
+ *
+ * Usage: q4Shooting.exe [tf target_x target_y [tol]]
+ */
+
+const char *statusName(NewtonStatus s) {
+    switch (s) {
+    case NewtonStatus::Converged: return "converged";
+    case NewtonStatus::MaxIterations: return "iteration limit";
+    case NewtonStatus::Singular: return "singular Jacobian";
+    case NewtonStatus::LineSearchFailed: return "no decrease in the miss";
+    }
+    return "";
+}
+
+int main(int argc, char *argv[]) {
+    double t0 = 0.0, h = 60.0;
+    double tf = 3.0 * 86400.0;
+    State<2> target = {2.0e8, 1.0e8};
+    ShootingOptions opt;
+    if (argc > 3) {
+        tf = atof(argv[1]);
+        target = {atof(argv[2]), atof(argv[3])};
+    }
+    if (argc > 4) opt.tol = atof(argv[4]);
+
+    State<2> r0 = {0.0, 26378100.0};
+    State<2> v_guess = {3887.3, 0.0};
+
+    cout << "Target (" << target[0] << ", " << target[1] << ") m at t = " << tf << " s, tolerance " << opt.tol
+         << " m" << endl;
+    for (ShootingJacobian jac : {ShootingJacobian::Variational, ShootingJacobian::Broyden}) {
+        opt.jacobian = jac;
+        auto start = chrono::steady_clock::now();
+        ShootingResult res = shootVelocity(EarthMoonModel(), t0, r0, v_guess, tf, target, h, opt);
+        double s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        cout << (jac == ShootingJacobian::Variational ? "Variational" : "Broyden") << ": "
+             << (res.converged ? "converged" : string("did not converge (") + statusName(res.status) + ")") << " after " << res.iterations
+             << " iterations, " << res.integrations << " integrations, " << s << " s" << endl;
+        cout << setprecision(10) << "  vx: " << res.v0[0] << ", vy: " << res.v0[1] << setprecision(6)
+             << ", miss " << res.miss_distance << " m" << endl;
+    }
+    return 0;
+}
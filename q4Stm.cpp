@@ -0,0 +1,80 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include "orbit.hpp"
+#include "variational.hpp"
+
+using namespace std;
+
+/* State transition matrix of the q4 orbit after one day of RK4 with
+ * h = 1 s, for the Earth only and the Earth+Moon models: the fused
+ * variational integration (variational.hpp) against central differences,
+ * which take 2 * 4 + 1 = 9 full integrations. Prints both matrices' largest
+ * relative difference and the time each took.
+ *
+ * Usage: q4Stm.exe [days]
+ */
+
+template <typename Run>
+double seconds(Run run) {
+    auto start = chrono::steady_clock::now();
+    run();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Column j of Phi is (y(y0 + d e_j) - y(y0 - d e_j)) / 2d
+template <typename Model>
+Matrix<4> finiteDifferenceStm(Model model, double t0, const OrbitState &y0, double h, double tf) {
+    const double step[4] = {1.0, 1.0, 1e-3, 1e-3}; // m, m, m/s, m/s
+    Matrix<4> phi;
+    rungeKutta4(model, t0, y0, h, tf); // The unperturbed run
+    for (int j = 0; j < 4; ++j) {
+        OrbitState yp = y0, ym = y0;
+        yp[j] += step[j];
+        ym[j] -= step[j];
+        OrbitState fp = rungeKutta4(model, t0, yp, h, tf);
+        OrbitState fm = rungeKutta4(model, t0, ym, h, tf);
+        for (int i = 0; i < 4; ++i) phi[i][j] = (fp[i] - fm[i]) / (2.0 * step[j]);
+    }
+    return phi;
+}
+
+template <typename Model>
+void compare(const string &name, Model model, double t0, const OrbitState &y0, double h, double tf) {
+    Matrix<4> phi, phi_fd;
+    OrbitState y;
+    double stm_s = seconds([&] { y = rungeKutta4Stm(model, t0, y0, h, tf, phi); });
+    double fd_s = seconds([&] { phi_fd = finiteDifferenceStm(model, t0, y0, h, tf); });
+
+    double max_rel = 0.0, norm = 0.0;
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) norm = max(norm, fabs(phi[i][j]));
+    }
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) max_rel = max(max_rel, fabs(phi[i][j] - phi_fd[i][j]) / norm);
+    }
+
+    cout << name << ": final state " << y[0] << " " << y[1] << " " << y[2] << " " << y[3] << endl;
+    cout << "Phi = d y(tf) / d y0 (variational):" << endl;
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) cout << setw(16) << phi[i][j];
+        cout << endl;
+    }
+    cout << "max |Phi - Phi_fd| / max |Phi| = " << max_rel << endl;
+    cout << "variational " << stm_s << " s (1 integration), central differences " << fd_s
+         << " s (9 integrations), speedup " << fd_s / stm_s << endl
+         << endl;
+}
+
+int main(int argc, char *argv[]) {
+    double days = argc > 1 ? atof(argv[1]) : 1.0;
+    double t0 = 0.0, h = 1.0, tf = days * 86400.0;
+    OrbitState y0 = {0.0, 26378100.0, 3887.3, 0.0}; // x0, y0, vx0, vy0
+
+    compare("Earth", EarthModel(), t0, y0, h, tf);
+    compare("Earth+Moon", EarthMoonModel(), t0, y0, h, tf);
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include "orbit.hpp"
+#include "symplectic.hpp"
+
+using namespace std;
+
+/* Energy and angular momentum drift report for long propagations.
+ * Each stepper runs the q4.cpp orbit for 30 days; we record the largest
+ * relative drift of the conserved quantities seen at any step, the number
+ * of force evaluations and the wall time.
+ */
+
+struct Drift {
+    double max_dE = 0.0; // max |E - E0| / |E0|
+    double max_dL = 0.0; // max |L - L0| / |L0|
+};
+
+template <typename Integrate>
+void report(const char *name, long evals_per_step, double h, double tf, double (*energy)(const OrbitState &),
+            const OrbitState &y0, Integrate integrate) {
+    double E0 = energy(y0);
+    double L0 = angular_momentum(y0);
+    Drift drift;
+
+    auto observer = [&](double, const OrbitState &y) {
+        drift.max_dE = max(drift.max_dE, fabs((energy(y) - E0) / E0));
+        drift.max_dL = max(drift.max_dL, fabs((angular_momentum(y) - L0) / L0));
+    };
+
+    auto start = chrono::steady_clock::now();
+    integrate(observer);
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    long evals = evals_per_step * static_cast<long>(ceil(tf / h));
+    cout << setw(10) << name << setw(8) << h << setw(12) << evals << setw(14) << drift.max_dE << setw(14)
+         << drift.max_dL << setw(12) << elapsed * 1e3 << endl;
+}
+
+void run(const char *title, RhsFunction<4> rhs, AccelFunction<2> accel, double (*energy)(const OrbitState &),
+         const OrbitState &y0, double tf) {
+    cout << title << " (tf = " << tf / 86400.0 << " days)" << endl;
+    cout << setw(10) << "method" << setw(8) << "h [s]" << setw(12) << "evals" << setw(14) << "max dE/E"
+         << setw(14) << "max dL/L" << setw(12) << "time [ms]" << endl;
+
+    double t0 = 0.0;
+    double steps[] = {60.0, 300.0};
+    for (double h : steps) {
+        report("euler", 1, h, tf, energy, y0, [&](auto &obs) { euler(rhs, t0, y0, h, tf, obs); });
+        report("rk4", 4, h, tf, energy, y0, [&](auto &obs) { rungeKutta4(rhs, t0, y0, h, tf, obs); });
+        report("verlet", 1, h, tf, energy, y0, [&](auto &obs) { velocityVerlet(accel, t0, y0, h, tf, obs); });
+        report("yoshida4", 3, h, tf, energy, y0, [&](auto &obs) { yoshida4(accel, t0, y0, h, tf, obs); });
+    }
+    cout << endl;
+}
+
+int main() {
+    // Initial conditions from q4.cpp
+    OrbitState y0 = {0.0, 26378100.0, 3887.3, 0.0}; // x0, y0, vx0, vy0
+    double tf = 30 * 86400.0;
+
+    run("Earth only", rhs_earth, accel_earth, energy_earth, y0, tf);
+    // Angular momentum is not conserved once the Moon pulls on the orbit
+    run("Earth + Moon", rhs_with_moon, accel_with_moon, energy_with_moon, y0, tf);
+
+    return 0;
+}
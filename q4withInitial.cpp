@@ -1,122 +1,142 @@
 #include <iostream>
 #include <fstream>
 #include <cmath>
-#include <valarray>
+#include <cstdlib>
+#include <iomanip>
+#include <vector>
+#include <future>
+#include <algorithm>
+#include "q3-4.hpp"
+#include "orbit.hpp"
+#include "dense.hpp"
+#include "thread_pool.hpp"
+#include "events.hpp"
+#include "trajectory.hpp"
 
 using namespace std;
 
-const double G = 6.67430e-11; // Gravitational constant
-const double M = 5.972e24;     // Mass of the Earth
-const double ML = 7.342e22;    // Mass of the Moon
-
-// Define the RHS function for ODEs with Moon's gravitational effect
-valarray<double> rhs_with_moon(double t, valarray<double> yvec) {
-    // Implement the RHS of the ODEs here
-    valarray<double> dydt(yvec.size());
-
-    double GM = G * M; // Earth's gravitational parameter
-    double GM_L = G * ML; // Moon's gravitational parameter
-    double x = yvec[0];
-    double y = yvec[1];
-    double vx = yvec[2];
-    double vy = yvec[3];
-
-    double r = sqrt(x * x + y * y);
-    double r_cubed = r * r * r;
-
-    // Position of the Moon
-    double xL = 384400000.0; // x position of the Moon
-    double yL = 0.0; // y position of the Moon
-
-    // Distance between the satellite and the Moon
-    double dx = x - xL;
-    double dy = y - yL;
-    double r_moon = sqrt(dx * dx + dy * dy);
-    double r_moon_cubed = r_moon * r_moon * r_moon;
-
-    // Gravitational effect of the Moon
-    double ax_moon = -GM_L * dx / r_moon_cubed;
-    double ay_moon = -GM_L * dy / r_moon_cubed;
-
-    dydt[0] = vx;
-    dydt[1] = vy;
-    dydt[2] = (-GM * x / r_cubed) + ax_moon;
-    dydt[3] = (-GM * y / r_cubed) + ay_moon;
-
-    return dydt;
-}
-
 // Runge-Kutta 4th order method
-valarray<double> rungeKutta4(double t0, valarray<double> y0, double h, double tf) {
-    double t = t0;
-    valarray<double> y = y0;
-    valarray<double> k1, k2, k3, k4;
-
-    // Evolution loop for 4th order Runge-Kutta
-    ofstream outFile("rk4_outputInitial.dat");
-    while (t < tf) {
-        k1 = h * rhs_with_moon(t, y);
-        k2 = h * rhs_with_moon(t + h / 2.0, y + k1 / 2.0);
-        k3 = h * rhs_with_moon(t + h / 2.0, y + k2 / 2.0);
-        k4 = h * rhs_with_moon(t + h, y + k3);
-
-        // Update y using the weighted average of slopes
-        y += (k1 + 2.0 * k2 + 2.0 * k3 + k4) / 6.0;
-
-        // Move to the next step
-        t += h;
-
-        if (fmod(t, 60.0) == 0) { // Print every 60 seconds
-            outFile << t << " " << y[0] << " " << y[1] << " " << y[2] << " " << y[3] << endl;
-        }
-    }
+OrbitState rungeKutta4(double t0, const OrbitState &y0, double h, double tf) {
+    // Evolution loop for 4th order Runge-Kutta, sampled every 60 seconds
+    // by dense output whatever the step size
+    TrajectoryWriter outFile("rk4_outputInitial.traj");
+    OrbitState y = rungeKutta4Dense(EarthMoonModel(), t0, y0, h, tf, 60.0, outFile.output());
     outFile.close();
 
     return y;
 }
 
-int main() {
+// Does launching along (vx, vy) scaled by `scale` take the satellite
+// beyond the Moon's x by tf? Candidates are integrated without output and
+// stop as soon as the crossing happens.
+bool reaches_moon(double scale, double vx, double vy, double t0, double h, double tf, double *t_cross = nullptr) {
+    OrbitState y0 = {0.0, 26378100.0, scale * vx, scale * vy}; // x0, y0, vx0, vy0
+
+    Event<4> cross_moon;
+    cross_moon.g = event_moon_x;
+    cross_moon.direction = +1;
+    cross_moon.terminal = true;
+    EventDetector<4> detector({cross_moon});
+
+    rungeKutta4Events(EarthMoonModel(), t0, y0, h, tf, detector);
+    if (detector.hits.empty()) return false;
+    if (t_cross) *t_cross = detector.hits[0].t;
+    return true;
+}
+
+int main(int argc, char *argv[]) {
     // Initial conditions
     double t0 = 0.0;
     double h = 60.0; // Time step (60 seconds)
 
-    // Vary initial velocity in steps of 10%
+    // Launch direction; the search scales this velocity
     double initial_vx = 3887.3;
     double initial_vy = 0.0;
     double tf = 86400.0; // Total integration time for one day
-    double max_vx = initial_vx;
-    double max_vy = initial_vy;
-
-    ofstream velFile("initial_velocities.dat");
+    double tol = 1e-3;   // Tolerance on the velocity in m/s
+    if (argc > 1) tf = atof(argv[1]);
+    if (argc > 2) tol = atof(argv[2]);
 
-    while (true) {
-        // Set initial velocity
-        valarray<double> y0 = {0.0, 26378100.0, max_vx, max_vy}; // x0, y0, vx0, vy0
+    ThreadPool pool;
+    unsigned P = max(2u, pool.size());
+    int evaluations = 0;
+    int rounds = 0;
 
-        // Solve using Runge-Kutta 4th order method with Moon's gravitational effect
-        valarray<double> y_rk4_with_moon = rungeKutta4(t0, y0, h, tf);
+    ofstream velFile("initial_velocities.dat");
 
-        // Check if the satellite shoots beyond the Moon
-        if (y_rk4_with_moon[0] > 384400000.0) {
-            cout << "Maximum initial velocity reached. Satellite shoots beyond the Moon." << endl;
-            cout << "Max vx: " << max_vx << ", Max vy: " << max_vy << endl;
-            break;
+    // Evaluate a batch of scale factors concurrently and log each outcome
+    auto evaluate = [&](const vector<double> &scales) {
+        vector<future<bool>> results;
+        for (double s : scales) {
+            results.push_back(pool.submit([=] { return reaches_moon(s, initial_vx, initial_vy, t0, h, tf); }));
         }
+        vector<bool> reached;
+        for (size_t k = 0; k < scales.size(); ++k) {
+            reached.push_back(results[k].get());
+            velFile << scales[k] * initial_vx << " " << scales[k] * initial_vy << " " << reached[k] << endl;
+        }
+        evaluations += static_cast<int>(scales.size());
+        rounds++;
+        return reached;
+    };
+
+    // Bracket: grow the velocity in steps of 10%, P candidates at a time,
+    // until one of them shoots beyond the Moon
+    double lo = 1.0, hi = 0.0;
+    if (evaluate({lo})[0]) {
+        cout << "Initial velocity already reaches beyond the Moon." << endl;
+        return 0;
+    }
+    while (hi == 0.0) {
+        vector<double> scales;
+        for (unsigned k = 1; k <= P; ++k) scales.push_back(lo * pow(1.1, k));
+        vector<bool> reached = evaluate(scales);
+        for (unsigned k = 0; k < P; ++k) {
+            if (reached[k]) {
+                hi = scales[k];
+                break;
+            }
+            lo = scales[k];
+        }
+        if (hi == 0.0 && lo > 100.0) {
+            cerr << "Error: no velocity up to " << lo * initial_vx << " m/s reaches the Moon by tf = " << tf
+                 << " s." << endl;
+            return 1;
+        }
+    }
 
-        // Record initial velocities
-        velFile << max_vx << " " << max_vy << endl;
-
-        // Increase initial velocity by 10%
-        max_vx *= 1.1;
-        max_vy *= 1.1;
-
-        // Increase total integration time if necessary
-        if (max_vx > 2 * initial_vx || max_vy > 2 * initial_vy) {
-            tf *= 2;
+    // Refine: split the bracket into P + 1 parts per round (multisection),
+    // assuming the outcome is monotone in the launch speed
+    double speed = hypot(initial_vx, initial_vy);
+    while ((hi - lo) * speed > tol) {
+        vector<double> scales;
+        for (unsigned k = 1; k <= P; ++k) scales.push_back(lo + (hi - lo) * k / (P + 1));
+        vector<bool> reached = evaluate(scales);
+        double new_hi = hi;
+        for (unsigned k = 0; k < P; ++k) {
+            if (reached[k]) {
+                new_hi = scales[k];
+                break;
+            }
+            lo = scales[k];
         }
+        hi = new_hi;
     }
 
     velFile.close();
 
+    // Write the trajectory only for the answer
+    double max_vx = hi * initial_vx;
+    double max_vy = hi * initial_vy;
+    OrbitState y0 = {0.0, 26378100.0, max_vx, max_vy}; // x0, y0, vx0, vy0
+    rungeKutta4(t0, y0, h, tf);
+    double t_cross = tf;
+    reaches_moon(hi, initial_vx, initial_vy, t0, h, tf, &t_cross);
+
+    cout << "Minimum velocity that shoots beyond the Moon within " << tf << " s:" << endl;
+    cout << setprecision(10) << "vx: " << max_vx << ", vy: " << max_vy << " (+/- " << tol << " m/s)" << endl;
+    cout << "Crosses the Moon's x at t = " << t_cross << " s" << endl;
+    cout << evaluations << " integrations in " << rounds << " rounds on " << pool.size() << " threads" << endl;
+
     return 0;
 }
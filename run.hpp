@@ -1,3 +1,6 @@
+#ifndef RUN_HPP
+#define RUN_HPP
+
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -9,7 +12,7 @@
 const double earthRadius = 6371000.0; // Radius of the Earth in meters
 
 // Function to read GPS data from a file and return a valarray
-std::valarray<double> read_gps_data(const std::string &filename, int N)
+inline std::valarray<double> read_gps_data(const std::string &filename, int N)
 {
     std::ifstream file(filename);
     if (!file.is_open())
@@ -56,7 +59,7 @@ std::valarray<double> read_gps_data(const std::string &filename, int N)
 }
 
 // Function to calculate distances between GPS coordinates
-std::valarray<double> coords_to_distances(const std::valarray<double> &lat, const std::valarray<double> &lon)
+inline std::valarray<double> coords_to_distances(const std::valarray<double> &lat, const std::valarray<double> &lon)
 {
     if (lat.size() != lon.size())
     {
@@ -82,7 +85,7 @@ std::valarray<double> coords_to_distances(const std::valarray<double> &lat, cons
 }
 
 // Function to calculate speeds from distances
-std::valarray<double> dl_to_speed(const std::valarray<double>& dl) {
+inline std::valarray<double> dl_to_speed(const std::valarray<double>& dl) {
     size_t N = dl.size();
     std::valarray<double> speed(N);
 
@@ -212,3 +215,5 @@ public:
 
 //     return 0;
 // }
+
+#endif // RUN_HPP
@@ -5,7 +5,7 @@
 #include <cmath>
 #include <string>
 #include <stdexcept>
-#include "run.cpp" // Include the Run class implementation
+#include "run.hpp" // Include the Run class implementation
 
 class Runner {
 private:
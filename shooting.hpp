@@ -0,0 +1,112 @@
+#ifndef SHOOTING_HPP
+#define SHOOTING_HPP
+
+#include <cmath>
+#include "newton.hpp"
+#include "ode.hpp"
+#include "variational.hpp"
+
+/* Shooting for the initial velocity: find v0 such that the orbit started
+ * at (r0, v0) passes through the target point at tf. The function solved
+ * is F(v0) = position(tf) - target, one rungeKutta4 run per evaluation,
+ * by the Newton solver of newton.hpp, which also damps the steps (so a
+ * poor first guess does not throw the iteration off) and stops rather
+ * than take a step that does not reduce the miss.
+ *
+ * The Jacobian dF/dv0 is the position-velocity block of the state
+ * transition matrix. With ShootingJacobian::Variational every evaluation
+ * of F is a fused variational integration (variational.hpp), which gives
+ * the Jacobian at the same point for free (NewtonMode::Newton). With
+ * ShootingJacobian::Broyden evaluations are plain integrations: the
+ * Jacobian comes from forward differences (two extra runs) and is then
+ * updated from the secant of each step (NewtonMode::Broyden), and
+ * re-estimated only when a step fails.
+ */
+
+enum class ShootingJacobian { Variational, Broyden };
+
+struct ShootingOptions {
+    double tol = 1e-3;     // Acceptable miss distance in meters
+    int max_iter = 30;     // Newton iterations
+    int max_halvings = 10; // Step halvings per iteration
+    ShootingJacobian jacobian = ShootingJacobian::Variational;
+    double fd_step = 1e-2; // Velocity step in m/s for Broyden's initial Jacobian
+};
+
+struct ShootingResult {
+    State<2> v0 = {};          // Initial velocity found
+    State<2> miss = {};        // Final position minus the target
+    double miss_distance = 0.0;
+    int iterations = 0;        // Newton steps taken
+    int integrations = 0;      // rungeKutta4 runs, with or without the STM
+    bool converged = false;
+    NewtonStatus status = NewtonStatus::MaxIterations;
+};
+
+template <typename Model>
+ShootingResult shootVelocity(Model model, double t0, const State<2> &r0, const State<2> &v_guess, double tf,
+                             const State<2> &target, double h, const ShootingOptions &opt = ShootingOptions()) {
+    ShootingResult res;
+    const bool variational = opt.jacobian == ShootingJacobian::Variational;
+
+    // The last evaluation, so the Jacobian at the point just evaluated
+    // (which is where the solver asks for it) costs no extra run
+    State<2> v_last = {NAN, NAN}, F_last;
+    Matrix<2> J_last;
+    auto evaluate = [&](const State<2> &v) {
+        if (v == v_last) return;
+        State<4> y0 = {r0[0], r0[1], v[0], v[1]}, y;
+        ++res.integrations;
+        if (variational) {
+            Matrix<4> phi;
+            y = rungeKutta4Stm(model, t0, y0, h, tf, phi);
+            for (int i = 0; i < 2; ++i) {
+                for (int j = 0; j < 2; ++j) J_last[i][j] = phi[i][2 + j];
+            }
+        } else {
+            y = rungeKutta4(model, t0, y0, h, tf);
+        }
+        v_last = v;
+        F_last = {y[0] - target[0], y[1] - target[1]};
+    };
+
+    auto f = [&](State<2> &F, const State<2> &v) {
+        evaluate(v);
+        F = F_last;
+    };
+    auto jac = [&](Matrix<2> &J, const State<2> &v) {
+        evaluate(v);
+        if (variational) {
+            J = J_last;
+            return;
+        }
+        // Forward differences
+        const State<2> F = F_last;
+        for (int j = 0; j < 2; ++j) {
+            State<2> vp = v;
+            vp[j] += opt.fd_step;
+            evaluate(vp);
+            for (int i = 0; i < 2; ++i) J[i][j] = (F_last[i] - F[i]) / opt.fd_step;
+        }
+    };
+
+    NewtonOptions nopt;
+    nopt.mode = variational ? NewtonMode::Newton : NewtonMode::Broyden;
+    nopt.ftol = opt.tol;
+    nopt.xtol = 0.0; // Converged on the miss distance only
+    nopt.max_iter = opt.max_iter;
+    nopt.max_halvings = opt.max_halvings;
+    NewtonStats st;
+    State<2> v = v_guess;
+    res.status = newtonSolve(f, jac, v, nopt, &st);
+
+    evaluate(v); // No run unless the solve ended on a rejected trial
+    res.v0 = v;
+    res.miss = F_last;
+    res.miss_distance = std::hypot(F_last[0], F_last[1]);
+    res.iterations = st.iterations;
+    res.converged = res.status == NewtonStatus::Converged;
+    return res;
+}
+
+#endif // SHOOTING_HPP
@@ -0,0 +1,99 @@
+#ifndef SYMPLECTIC_HPP
+#define SYMPLECTIC_HPP
+
+#include <cmath>
+#include "ode.hpp"
+
+/* Symplectic steppers for separable problems y = (q, v) with q' = v and
+ * v' = a(t, q). The state keeps the same layout as the other steppers:
+ * the first D components are positions, the last D velocities.
+ */
+
+/* In-place acceleration contract: accel(t, q, a) fills a with a(t, q).
+ * Like the rhs, accel may be a function or a model functor.
+ */
+template <std::size_t D>
+using AccelFunction = void (*)(double t, const State<D> &q, State<D> &a);
+
+// Velocity Verlet (kick-drift-kick), 2nd order
+// One acceleration evaluation per step: the end-of-step acceleration is
+// reused as the start of the next one. out(t, y) is called after every step.
+template <std::size_t N, typename Accel, typename Output = NoOutput>
+State<N> velocityVerlet(Accel accel, double t0, const State<N> &y0, double h, double tf, Output out = Output()) {
+    static_assert(N % 2 == 0, "state must be positions followed by velocities");
+    constexpr std::size_t D = N / 2;
+
+    double t = t0;
+    State<D> q, v, a;
+    for (std::size_t i = 0; i < D; ++i) {
+        q[i] = y0[i];
+        v[i] = y0[D + i];
+    }
+    accel(t, q, a);
+
+    State<N> y = y0;
+    while (t < tf) {
+        for (std::size_t i = 0; i < D; ++i) {
+            v[i] += 0.5 * h * a[i];
+            q[i] += h * v[i];
+        }
+        accel(t + h, q, a);
+        for (std::size_t i = 0; i < D; ++i) v[i] += 0.5 * h * a[i];
+
+        t += h;
+
+        for (std::size_t i = 0; i < D; ++i) {
+            y[i] = q[i];
+            y[D + i] = v[i];
+        }
+        out(t, y);
+    }
+
+    return y;
+}
+
+// Yoshida's 4th order composition of leapfrog
+// Three acceleration evaluations per step (drift-kick-drift form).
+template <std::size_t N, typename Accel, typename Output = NoOutput>
+State<N> yoshida4(Accel accel, double t0, const State<N> &y0, double h, double tf, Output out = Output()) {
+    static_assert(N % 2 == 0, "state must be positions followed by velocities");
+    constexpr std::size_t D = N / 2;
+
+    const double cbrt2 = std::cbrt(2.0);
+    const double w1 = 1.0 / (2.0 - cbrt2);
+    const double w0 = -cbrt2 / (2.0 - cbrt2);
+    // Drift (c) and kick (d) weights
+    const double c[4] = {w1 / 2.0, (w0 + w1) / 2.0, (w0 + w1) / 2.0, w1 / 2.0};
+    const double d[3] = {w1, w0, w1};
+
+    double t = t0;
+    State<D> q, v, a;
+    for (std::size_t i = 0; i < D; ++i) {
+        q[i] = y0[i];
+        v[i] = y0[D + i];
+    }
+
+    State<N> y = y0;
+    while (t < tf) {
+        double ts = t;
+        for (int s = 0; s < 3; ++s) {
+            for (std::size_t i = 0; i < D; ++i) q[i] += c[s] * h * v[i];
+            ts += c[s] * h;
+            accel(ts, q, a);
+            for (std::size_t i = 0; i < D; ++i) v[i] += d[s] * h * a[i];
+        }
+        for (std::size_t i = 0; i < D; ++i) q[i] += c[3] * h * v[i];
+
+        t += h;
+
+        for (std::size_t i = 0; i < D; ++i) {
+            y[i] = q[i];
+            y[D + i] = v[i];
+        }
+        out(t, y);
+    }
+
+    return y;
+}
+
+#endif // SYMPLECTIC_HPP
@@ -0,0 +1,74 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/* Fixed-size pool of worker threads fed from a single FIFO queue.
+ * submit() returns a future for the task's result.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned n_threads = std::thread::hardware_concurrency()) {
+        if (n_threads == 0) n_threads = 1;
+        for (unsigned i = 0; i < n_threads; ++i) {
+            workers.emplace_back([this] { work(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (std::thread &w : workers) w.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    template <typename F>
+    auto submit(F task) -> std::future<decltype(task())> {
+        using R = decltype(task());
+        auto job = std::make_shared<std::packaged_task<R()>>(std::move(task));
+        std::future<R> result = job->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace([job] { (*job)(); });
+        }
+        cv.notify_one();
+        return result;
+    }
+
+private:
+    void work() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,299 @@
+#ifndef TRAJECTORY_HPP
+#define TRAJECTORY_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "ode.hpp"
+
+/* Binary columnar trajectory files (.traj), replacing the text .dat
+ * output. Every value is stored as a full-precision double, column by
+ * column, so a file can be memory-mapped and a column read without
+ * parsing (numpy: trajectory.py).
+ *
+ * The rows are stored in blocks of B rows so the writer can stream them
+ * out with a fixed amount of memory: each block holds its slice of every
+ * column, one contiguous array per column. Only the last block may be
+ * short. A file of at most B rows is therefore plain contiguous columns.
+ *
+ * Layout, in the byte order of the writing host:
+ *   0   char[8]  magic "ORBTRAJ1"
+ *   8   uint32   version (2)
+ *   12  uint32   number of columns C
+ *   16  uint64   number of rows R (rewritten after every block)
+ *   24  uint64   offset of the first block (a multiple of 64)
+ *   32  uint64   rows per block B
+ *   40  uint32   byte-order mark 0x01020304 (bytes 04 03 02 01 on a
+ *                little-endian host); readers reject foreign files
+ *   44  uint32   zero
+ *   48  char[16] name of each column, NUL padded (C entries)
+ *   ... zero padding up to the data offset
+ *   then the blocks: block b starts at offset + b * B * C * 8 and holds
+ *   C arrays of n = min(B, R - b * B) float64, column c at c * n * 8.
+ */
+
+namespace traj {
+const char magic[8] = {'O', 'R', 'B', 'T', 'R', 'A', 'J', '1'};
+const std::uint32_t version = 2;
+const std::uint32_t byte_order = 0x01020304;
+const std::size_t name_size = 16;
+const std::size_t header_size = 48;
+const std::size_t align = 64;
+const std::size_t block_rows = 8192; // 64 KiB per column and block
+
+// Byte offset of the first block for C columns
+inline std::uint64_t dataOffset(std::size_t columns) {
+    std::size_t end = header_size + columns * name_size;
+    return (end + align - 1) / align * align;
+}
+
+// t plus x, y, vx, vy for orbit states, t plus y0, y1, ... otherwise
+inline std::vector<std::string> defaultColumns(std::size_t dim) {
+    if (dim == 4) return {"t", "x", "y", "vx", "vy"};
+    std::vector<std::string> names = {"t"};
+    for (std::size_t i = 0; i < dim; ++i) names.push_back("y" + std::to_string(i));
+    return names;
+}
+
+// Fixed header fields, as stored
+struct Header {
+    std::uint32_t version = 0, ncol = 0;
+    std::uint64_t rows = 0, offset = 0, block = 0;
+    std::uint32_t byte_order = 0;
+};
+
+// Parse the first header_size bytes; false, with a message, if they are
+// not a trajectory header this build can read
+inline bool parseHeader(const char *p, Header &h, const std::string &path) {
+    std::memcpy(&h.version, p + 8, sizeof h.version);
+    std::memcpy(&h.ncol, p + 12, sizeof h.ncol);
+    std::memcpy(&h.rows, p + 16, sizeof h.rows);
+    std::memcpy(&h.offset, p + 24, sizeof h.offset);
+    std::memcpy(&h.block, p + 32, sizeof h.block);
+    std::memcpy(&h.byte_order, p + 40, sizeof h.byte_order);
+    if (std::memcmp(p, magic, sizeof magic) != 0) {
+        std::cerr << "Not a trajectory file: " << path << std::endl;
+        return false;
+    }
+    if (h.byte_order == 0x04030201) {
+        std::cerr << "Trajectory file from a host of the other byte order: " << path << std::endl;
+        return false;
+    }
+    if (h.version != version || h.byte_order != byte_order || h.block == 0 || h.offset % sizeof(double) != 0) {
+        std::cerr << "Unsupported trajectory file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+} // namespace traj
+
+/* Streams rows to the file: they collect in a one-block buffer (B rows
+ * of every column), which is written out as soon as it is full, and the
+ * row count in the header is updated after each block, so memory stays
+ * fixed however long the run and the file is readable up to the last
+ * full block while it is written. close() writes the last, short block.
+ * Use output() as the observer of any stepper.
+ */
+class TrajectoryWriter {
+public:
+    TrajectoryWriter(const std::string &path, std::vector<std::string> names = traj::defaultColumns(4))
+        : path(path), names(std::move(names)), block(this->names.size() * traj::block_rows),
+          out(path, std::ios::binary | std::ios::trunc) {
+        if (!out.is_open()) {
+            std::cerr << "Error opening file: " << path << std::endl;
+            failed = true;
+            return;
+        }
+        std::uint32_t ncol = static_cast<std::uint32_t>(this->names.size()), zero = 0;
+        std::uint64_t nrow = 0, offset = traj::dataOffset(this->names.size()), brows = traj::block_rows;
+        out.write(traj::magic, sizeof traj::magic);
+        out.write(reinterpret_cast<const char *>(&traj::version), sizeof traj::version);
+        out.write(reinterpret_cast<const char *>(&ncol), sizeof ncol);
+        out.write(reinterpret_cast<const char *>(&nrow), sizeof nrow);
+        out.write(reinterpret_cast<const char *>(&offset), sizeof offset);
+        out.write(reinterpret_cast<const char *>(&brows), sizeof brows);
+        out.write(reinterpret_cast<const char *>(&traj::byte_order), sizeof traj::byte_order);
+        out.write(reinterpret_cast<const char *>(&zero), sizeof zero);
+        for (const std::string &name : this->names) {
+            char field[traj::name_size] = {};
+            std::strncpy(field, name.c_str(), traj::name_size - 1);
+            out.write(field, sizeof field);
+        }
+        std::vector<char> pad(offset - traj::header_size - this->names.size() * traj::name_size, 0);
+        out.write(pad.data(), pad.size());
+    }
+
+    ~TrajectoryWriter() { close(); }
+
+    TrajectoryWriter(const TrajectoryWriter &) = delete;
+    TrajectoryWriter &operator=(const TrajectoryWriter &) = delete;
+
+    // Append a row. A state whose size does not match the columns is
+    // rejected (returns false) and makes close() report the error.
+    template <std::size_t N>
+    bool write(double t, const State<N> &y) {
+        if (N + 1 != names.size()) {
+            if (rejected++ == 0) {
+                std::cerr << "Error: " << N + 1 << " values for the " << names.size() << " columns of " << path
+                          << std::endl;
+            }
+            return false;
+        }
+        block[fill] = t;
+        for (std::size_t i = 0; i < N; ++i) block[(i + 1) * traj::block_rows + fill] = y[i];
+        if (++fill == traj::block_rows) flush();
+        return true;
+    }
+
+    // Observer to pass to the steppers: out(t, y) appends a row
+    struct Output {
+        TrajectoryWriter *w;
+        template <std::size_t N>
+        void operator()(double t, const State<N> &y) const {
+            w->write(t, y);
+        }
+    };
+    Output output() { return {this}; }
+
+    std::size_t rows() const { return written + fill; }
+
+    // Write the buffered rows; later rows are dropped. Returns false on I/O
+    // errors or if any row was rejected.
+    bool close() {
+        if (closed) return !failed && rejected == 0;
+        closed = true;
+        flush();
+        if (out.is_open()) out.close();
+        if (!failed && out.fail()) {
+            std::cerr << "Error writing file: " << path << std::endl;
+            failed = true;
+        }
+        if (rejected > 0) std::cerr << rejected << " rows rejected for " << path << std::endl;
+        return !failed && rejected == 0;
+    }
+
+private:
+    // Append the buffered rows as one block and record them in the header
+    void flush() {
+        if (fill == 0 || failed) {
+            fill = 0;
+            return;
+        }
+        for (std::size_t c = 0; c < names.size(); ++c) {
+            out.write(reinterpret_cast<const char *>(&block[c * traj::block_rows]), fill * sizeof(double));
+        }
+        written += fill;
+        fill = 0;
+        std::uint64_t nrow = written;
+        out.seekp(16);
+        out.write(reinterpret_cast<const char *>(&nrow), sizeof nrow);
+        out.seekp(0, std::ios::end);
+        if (!out.good()) {
+            std::cerr << "Error writing file: " << path << std::endl;
+            failed = true;
+        }
+    }
+
+    std::string path;
+    std::vector<std::string> names;
+    std::vector<double> block; // Column c of the current block at c * block_rows
+    std::ofstream out;
+    std::size_t fill = 0;      // Rows in block
+    std::uint64_t written = 0; // Rows in the file
+    long rejected = 0;
+    bool failed = false;
+    bool closed = false;
+};
+
+/* Plain-text rows "t y0 y1 ..." at full precision, for tools that want
+ * text. Same write/close interface as TrajectoryWriter, so it can sit
+ * behind an AsyncWriter (async_writer.hpp) and format off the hot path.
+ */
+class TextTrajectoryWriter {
+public:
+    explicit TextTrajectoryWriter(const std::string &path) : path(path), out(path) {
+        if (!out.is_open()) std::cerr << "Error opening file: " << path << std::endl;
+        out.precision(17);
+    }
+
+    TextTrajectoryWriter(const TextTrajectoryWriter &) = delete;
+    TextTrajectoryWriter &operator=(const TextTrajectoryWriter &) = delete;
+
+    template <std::size_t N>
+    void write(double t, const State<N> &y) {
+        out << t;
+        for (double v : y) out << ' ' << v;
+        out << '\n';
+    }
+
+    bool close() {
+        if (!out.is_open()) return false;
+        out.close();
+        if (out.fail()) {
+            std::cerr << "Error writing file: " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    std::string path;
+    std::ofstream out;
+};
+
+/* A whole trajectory file read into memory */
+struct Trajectory {
+    std::vector<std::string> names;
+    std::vector<std::vector<double>> columns;
+
+    std::size_t rows() const { return columns.empty() ? 0 : columns[0].size(); }
+
+    // Column by name, nullptr if there is none
+    const std::vector<double> *column(const std::string &name) const {
+        for (std::size_t c = 0; c < names.size(); ++c) {
+            if (names[c] == name) return &columns[c];
+        }
+        return nullptr;
+    }
+};
+
+inline bool readTrajectory(const std::string &path, Trajectory &traj) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Error opening file: " << path << std::endl;
+        return false;
+    }
+
+    char header[traj::header_size];
+    traj::Header h;
+    if (!in.read(header, sizeof header)) {
+        std::cerr << "Not a trajectory file: " << path << std::endl;
+        return false;
+    }
+    if (!traj::parseHeader(header, h, path)) return false;
+
+    Trajectory t;
+    for (std::uint32_t c = 0; c < h.ncol; ++c) {
+        char field[traj::name_size + 1] = {};
+        in.read(field, traj::name_size);
+        t.names.push_back(field);
+    }
+    in.seekg(h.offset);
+    t.columns.assign(h.ncol, std::vector<double>(h.rows));
+    for (std::uint64_t first = 0; first < h.rows; first += h.block) {
+        std::uint64_t n = std::min<std::uint64_t>(h.block, h.rows - first);
+        for (std::vector<double> &c : t.columns) in.read(reinterpret_cast<char *>(&c[first]), n * sizeof(double));
+    }
+    if (!in.good()) {
+        std::cerr << "Truncated trajectory file: " << path << std::endl;
+        return false;
+    }
+    traj = std::move(t);
+    return true;
+}
+
+#endif // TRAJECTORY_HPP
@@ -0,0 +1,77 @@
+import numpy as np
+
+# Reader for the binary columnar .traj files written by TrajectoryWriter
+# (trajectory.hpp). The rows are stored in blocks of B rows, each holding
+# its slice of every column; a file of one block is memory-mapped, not
+# copied, and longer ones have each column joined from its blocks.
+
+MAGIC = b"ORBTRAJ1"
+VERSION = 2
+NAME_SIZE = 16
+HEADER_SIZE = 48
+
+
+def load_trajectory(filename):
+    """Return a dict of column name -> read-only float64 array."""
+    with open(filename, "rb") as f:
+        header = f.read(HEADER_SIZE)
+        if len(header) < HEADER_SIZE or header[:8] != MAGIC:
+            raise ValueError(filename + " is not a trajectory file")
+        # The byte-order mark 0x01020304 gives the byte order of the writer
+        mark = header[40:44]
+        if mark == b"\x04\x03\x02\x01":
+            order = "<"
+        elif mark == b"\x01\x02\x03\x04":
+            order = ">"
+        else:
+            raise ValueError(filename + ": bad trajectory byte-order mark")
+        version, ncol = np.frombuffer(header, dtype=order + "u4", count=2, offset=8)
+        if version != VERSION:
+            raise ValueError(filename + ": unsupported trajectory version " + str(version))
+        nrow, offset, block = (int(v) for v in np.frombuffer(header, dtype=order + "u8", count=3, offset=16))
+        ncol = int(ncol)
+        names = [f.read(NAME_SIZE).split(b"\0")[0].decode() for _ in range(ncol)]
+
+    dtype = order + "f8"
+    if nrow <= block:
+        data = np.memmap(filename, dtype=dtype, mode="r", offset=offset, shape=(ncol, nrow))
+        return {name: data[c] for c, name in enumerate(names)}
+
+    full, tail = divmod(nrow, block)
+    data = np.memmap(filename, dtype=dtype, mode="r", offset=offset, shape=(ncol * nrow,))
+    blocks = data[: full * block * ncol].reshape(full, ncol, block)
+    last = data[full * block * ncol :].reshape(ncol, tail)
+    columns = {}
+    for c, name in enumerate(names):
+        column = np.concatenate([blocks[:, c, :].reshape(-1), last[c]])
+        column.flags.writeable = False
+        columns[name] = column
+    return columns
+
+
+def load_columns(filename):
+    """Rows as a 2D array with columns t, x, y, vx, vy, like np.loadtxt on the old .dat files."""
+    columns = load_trajectory(filename)
+    return np.stack(list(columns.values()), axis=1)
+
+
+def hermite_states(filename, t):
+    """States at times t from a file written through a Decimator
+    (decimation.hpp): cubic Hermite in position with the stored velocities
+    as derivatives. Returns an array of rows x, y, vx, vy."""
+    c = load_trajectory(filename)
+    tk = c["t"]
+    t = np.atleast_1d(np.asarray(t, dtype=float))
+    k = np.clip(np.searchsorted(tk, t, side="right") - 1, 0, len(tk) - 2)
+    h = tk[k + 1] - tk[k]
+    s = (t - tk[k]) / h
+    s2, s3 = s * s, s * s * s
+    h00, h10, h01, h11 = 2 * s3 - 3 * s2 + 1, (s3 - 2 * s2 + s) * h, -2 * s3 + 3 * s2, (s3 - s2) * h
+    d00, d10, d11 = (6 * s2 - 6 * s) / h, 3 * s2 - 4 * s + 1, 3 * s2 - 2 * s
+    out = []
+    for p, v in (("x", "vx"), ("y", "vy")):
+        p0, p1, v0, v1 = c[p][k], c[p][k + 1], c[v][k], c[v][k + 1]
+        out.append((p, h00 * p0 + h10 * v0 + h01 * p1 + h11 * v1))
+        out.append((v, d00 * p0 + d10 * v0 - d00 * p1 + d11 * v1))
+    cols = dict(out)
+    return np.stack([cols["x"], cols["y"], cols["vx"], cols["vy"]], axis=1)
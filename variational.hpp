@@ -0,0 +1,103 @@
+#ifndef VARIATIONAL_HPP
+#define VARIATIONAL_HPP
+
+#include <cstddef>
+#include "ode.hpp"
+
+/* State transition matrix by the variational equations.
+ *
+ * For y = (q, v) with q' = v, v' = a(t, q), the sensitivity
+ * Phi = d y(t) / d y(t0) obeys Phi' = A Phi with A = [[0, I], [G, 0]],
+ * where G = d a / d q is the model's analytic gradient(). Variational<Model>
+ * is the rhs of the state and Phi stacked in one vector, so a single
+ * integration by any stepper gives both, instead of 2n + 1 runs for
+ * central differences. The Jacobian is evaluated at the same stage points
+ * as the state, so Phi is the exact derivative of the discrete RK4 map up
+ * to round-off.
+ *
+ * D is the number of position components (2 for the models in orbit.hpp,
+ * giving the 4 x 4 matrix; a 3D model would give 6 x 6).
+ */
+template <typename Model, std::size_t D = 2>
+struct Variational {
+    static constexpr std::size_t n = 2 * D;       // State size
+    static constexpr std::size_t dim = n + n * n; // State then Phi, row-major
+
+    Model model;
+
+    explicit Variational(Model model = Model()) : model(model) {}
+
+    void operator()(double t, const State<dim> &z, State<dim> &dz) const {
+        State<D> q, a;
+        Matrix<D> g;
+        for (std::size_t i = 0; i < D; ++i) q[i] = z[i];
+        model.accel(t, q, a);
+        model.gradient(t, q, g);
+
+        for (std::size_t i = 0; i < D; ++i) {
+            dz[i] = z[D + i];
+            dz[D + i] = a[i];
+        }
+
+        // Top rows of Phi': the velocity rows of Phi
+        const double *phi = &z[n];
+        double *dphi = &dz[n];
+        for (std::size_t i = 0; i < D; ++i) {
+            for (std::size_t j = 0; j < n; ++j) dphi[i * n + j] = phi[(D + i) * n + j];
+        }
+        // Bottom rows: G times the position rows of Phi
+        for (std::size_t i = 0; i < D; ++i) {
+            for (std::size_t j = 0; j < n; ++j) {
+                double s = 0.0;
+                for (std::size_t k = 0; k < D; ++k) s += g[i][k] * phi[k * n + j];
+                dphi[(D + i) * n + j] = s;
+            }
+        }
+    }
+};
+
+// Stack y and Phi into the variational state
+template <std::size_t N>
+State<N + N * N> packVariational(const State<N> &y, const Matrix<N> &phi) {
+    State<N + N * N> z;
+    for (std::size_t i = 0; i < N; ++i) z[i] = y[i];
+    for (std::size_t i = 0; i < N; ++i) {
+        for (std::size_t j = 0; j < N; ++j) z[N + i * N + j] = phi[i][j];
+    }
+    return z;
+}
+
+template <std::size_t N>
+void unpackVariational(const State<N + N * N> &z, State<N> &y, Matrix<N> &phi) {
+    for (std::size_t i = 0; i < N; ++i) y[i] = z[i];
+    for (std::size_t i = 0; i < N; ++i) {
+        for (std::size_t j = 0; j < N; ++j) phi[i][j] = z[N + i * N + j];
+    }
+}
+
+template <std::size_t N>
+Matrix<N> identityMatrix() {
+    Matrix<N> m = {};
+    for (std::size_t i = 0; i < N; ++i) m[i][i] = 1.0;
+    return m;
+}
+
+// Runge-Kutta 4th order method propagating the state and its transition
+// matrix together. phi receives d y(tf) / d y0; out(t, y) is called after
+// every step with the state only.
+template <typename Model, typename Output = NoOutput>
+State<4> rungeKutta4Stm(Model model, double t0, const State<4> &y0, double h, double tf, Matrix<4> &phi,
+                        Output out = Output()) {
+    typedef Variational<Model, 2> Var;
+    auto observe = [&](double t, const State<Var::dim> &z) {
+        State<4> y;
+        for (std::size_t i = 0; i < 4; ++i) y[i] = z[i];
+        out(t, y);
+    };
+    State<Var::dim> z = rungeKutta4(Var(model), t0, packVariational(y0, identityMatrix<4>()), h, tf, observe);
+    State<4> y;
+    unpackVariational(z, y, phi);
+    return y;
+}
+
+#endif // VARIATIONAL_HPP
@@ -0,0 +1,169 @@
+#ifndef WORK_STEALING_HPP
+#define WORK_STEALING_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Worker threads with one deque of index ranges each, for loops whose
+ * iterations take very different times (adaptive or event-terminated
+ * trajectories).
+ *
+ * parallelFor(n, f) hands every worker one contiguous block of [0, n).
+ * A worker splits its current range in half until it is no larger than
+ * the grain, pushing the upper halves onto the back of its own deque, and
+ * takes more work from that back (newest, smallest, still in cache). An
+ * idle worker steals from the front of another worker's deque, which
+ * holds that worker's largest remaining range. So threads only touch a
+ * shared queue when they run out of their own work.
+ *
+ * Unlike ThreadPool (one FIFO queue, one task per submit), there is no
+ * per-item allocation or global lock. parallelFor must not be called from
+ * inside a task.
+ */
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(unsigned n_threads = std::thread::hardware_concurrency()) {
+        if (n_threads == 0) n_threads = 1;
+        for (unsigned i = 0; i < n_threads; ++i) queues.emplace_back(new Queue);
+        for (unsigned i = 0; i < n_threads; ++i) {
+            workers.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (std::thread &w : workers) w.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    // Number of ranges taken from another worker's deque so far
+    unsigned long steals() const { return n_steals.load(); }
+
+    // Call f(i) for every i in [0, n) and wait until all calls are done
+    template <typename F>
+    void parallelFor(std::size_t n, F f, std::size_t grain = 1) {
+        if (n == 0) return;
+        std::function<void(std::size_t)> fn(std::move(f));
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &fn;
+            this->grain = grain < 1 ? 1 : grain;
+            pending.store(n);
+
+            std::size_t w = queues.size();
+            for (std::size_t k = 0; k < w; ++k) {
+                Range r = {n * k / w, n * (k + 1) / w};
+                if (r.begin == r.end) continue;
+                std::lock_guard<std::mutex> qlock(queues[k]->mutex);
+                queues[k]->ranges.push_back(r);
+            }
+            ++generation;
+        }
+        cv.notify_all();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return pending.load() == 0; });
+        job = nullptr;
+    }
+
+private:
+    struct Range {
+        std::size_t begin, end;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Range> ranges;
+    };
+
+    bool popLocal(unsigned me, Range &r) {
+        Queue &q = *queues[me];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.ranges.empty()) return false;
+        r = q.ranges.back();
+        q.ranges.pop_back();
+        return true;
+    }
+
+    bool steal(unsigned me, Range &r) {
+        std::size_t w = queues.size();
+        for (std::size_t k = 1; k < w; ++k) {
+            Queue &q = *queues[(me + k) % w];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.ranges.empty()) continue;
+            r = q.ranges.front();
+            q.ranges.pop_front();
+            n_steals++;
+            return true;
+        }
+        return false;
+    }
+
+    void run(unsigned me, Range r) {
+        // Keep the lower half, leave the upper half where thieves can find it
+        while (r.end - r.begin > grain) {
+            std::size_t mid = r.begin + (r.end - r.begin) / 2;
+            {
+                std::lock_guard<std::mutex> lock(queues[me]->mutex);
+                queues[me]->ranges.push_back({mid, r.end});
+            }
+            r.end = mid;
+        }
+        for (std::size_t i = r.begin; i < r.end; ++i) (*job)(i);
+
+        std::size_t count = r.end - r.begin;
+        if (pending.fetch_sub(count) == count) {
+            std::lock_guard<std::mutex> lock(mutex);
+            done.notify_all();
+        }
+    }
+
+    void work(unsigned me) {
+        unsigned long seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+
+            // Drain until every index of this job has run
+            Range r;
+            while (pending.load() > 0) {
+                if (popLocal(me, r) || steal(me, r)) {
+                    run(me, r);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::mutex mutex;
+    std::condition_variable cv, done;
+    const std::function<void(std::size_t)> *job = nullptr;
+    std::size_t grain = 1;
+    std::atomic<std::size_t> pending{0};
+    std::atomic<unsigned long> n_steals{0};
+    unsigned long generation = 0;
+    bool stopping = false;
+};
+
+#endif // WORK_STEALING_HPP